@@ -0,0 +1,988 @@
+#ifndef AISDI_MAPS_BTREEMAP_H
+#define AISDI_MAPS_BTREEMAP_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <functional>
+
+namespace aisdi
+{
+
+  const size_t bTreeNodeBytes = 256;    //payload of a node, four cache lines
+  const size_t bTreeMinCapacity = 4;
+  const size_t bTreeMaxDepth = 64;      //inner nodes keep at least two children, so this covers any size_type count
+
+template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType> >
+class BTreeMap //B+ tree, entries sit in leaves linked in key order, inner nodes hold only separator keys
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using key_compare = Compare;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  static const size_type leafCapacity = bTreeNodeBytes / sizeof(value_type) > bTreeMinCapacity
+                                        ? bTreeNodeBytes / sizeof(value_type) : bTreeMinCapacity;
+  static const size_type innerCapacity = bTreeNodeBytes / (sizeof(key_type) + sizeof(void*)) > bTreeMinCapacity
+                                         ? bTreeNodeBytes / (sizeof(key_type) + sizeof(void*)) : bTreeMinCapacity;
+  static const size_type leafMinimum = leafCapacity / 2;
+  static const size_type innerMinimum = innerCapacity / 2;
+
+  struct Node
+  {
+    bool leaf;
+    size_type count;    //entries of a leaf, separator keys of an inner node
+
+    explicit Node(bool isLeaf) : leaf(isLeaf), count(0)
+    {}
+  };
+
+  struct Leaf : Node
+  {
+    Leaf* previous;
+    Leaf* next;
+    alignas(value_type) unsigned char storage[(leafCapacity + 1) * sizeof(value_type)];  //one spare slot, an overfull leaf splits right after the insert
+
+    Leaf() : Node(true), previous(nullptr), next(nullptr)
+    {}
+
+    value_type* slot(size_type index)
+    {
+      return reinterpret_cast<value_type*>(storage) + index;
+    }
+
+    value_type& at(size_type index)
+    {
+      return *std::launder(slot(index));
+    }
+
+    const value_type& at(size_type index) const
+    {
+      return *std::launder(reinterpret_cast<const value_type*>(storage) + index);
+    }
+  };
+
+  struct Inner : Node
+  {
+    key_type keys[innerCapacity + 1];     //children[i] holds the keys below keys[i], spare key and child as in Leaf
+    Node* children[innerCapacity + 2];
+
+    Inner() : Node(false)
+    {}
+  };
+
+  struct Path //the inner nodes passed on the way down and the child taken in each
+  {
+    Inner* nodes[bTreeMaxDepth];
+    size_type indices[bTreeMaxDepth];
+    size_type depth;
+  };
+
+  using position = std::pair<Leaf*, size_type>;  //(nullptr, 0) is the end
+
+  Node* root;
+  Leaf* firstLeaf;
+  Leaf* lastLeaf;
+  size_type size;
+  key_compare comp;
+
+  friend class ConstIterator;
+  friend class Iterator;
+
+  static void moveSlot(Leaf* from, size_type fromIndex, Leaf* to, size_type toIndex) //the const key rules out assignment, so entries are rebuilt
+  {
+    new (to->slot(toIndex)) value_type(std::move(from->at(fromIndex)));
+    from->at(fromIndex).~value_type();
+  }
+
+  static position normalized(Leaf* leaf, size_type index) //an index one past a leaf's entries means the next leaf's first one
+  {
+    if(index == leaf->count)
+      return position(leaf->next, 0);
+
+    return position(leaf, index);
+  }
+
+  //both scans count instead of stopping at the first match, a node is only a few cache lines and no branch depends on the keys
+
+  template <typename K>
+  size_type leafPosition(const Leaf* leaf, const K& key) const //first entry not less than key
+  {
+    size_type index = 0;
+
+    for(size_type i = 0; i < leaf->count; i++)
+    {
+      index += comp(leaf->at(i).first, key) ? 1 : 0;
+    }
+
+    return index;
+  }
+
+  template <typename K>
+  size_type childIndex(const Inner* inner, const K& key) const //first separator greater than key
+  {
+    size_type index = 0;
+
+    for(size_type i = 0; i < inner->count; i++)
+    {
+      index += comp(key, inner->keys[i]) ? 0 : 1;
+    }
+
+    return index;
+  }
+
+  template <typename K>
+  Leaf* descend(const K& key, Path* path) const //root must not be nullptr, path is filled in if given
+  {
+    Node* current = root;
+
+    if(path != nullptr)
+      path->depth = 0;
+
+    while(!current->leaf)
+    {
+      Inner* inner = static_cast<Inner*>(current);
+      size_type index = childIndex(inner, key);
+
+      if(path != nullptr)
+      {
+        path->nodes[path->depth] = inner;
+        path->indices[path->depth] = index;
+        path->depth++;
+      }
+
+      current = inner->children[index];
+    }
+
+    return static_cast<Leaf*>(current);
+  }
+
+  template <typename K>
+  position locate(const K& key) const
+  {
+    if(root == nullptr)
+      return position(nullptr, 0);
+
+    Leaf* leaf = descend(key, nullptr);
+    size_type index = leafPosition(leaf, key);
+
+    if(index == leaf->count || comp(key, leaf->at(index).first))
+      return position(nullptr, 0);
+
+    return position(leaf, index);
+  }
+
+  Leaf* splitLeaf(Leaf* leaf) //moves the upper half of an overfull leaf into a new right neighbour
+  {
+    Leaf* right = new Leaf();
+    size_type half = leaf->count / 2;
+
+    for(size_type i = half; i < leaf->count; i++)
+    {
+      moveSlot(leaf, i, right, i - half);
+    }
+    right->count = leaf->count - half;
+    leaf->count = half;
+
+    right->previous = leaf;
+    right->next = leaf->next;
+    if(leaf->next != nullptr)
+      leaf->next->previous = right;
+    else
+      lastLeaf = right;
+    leaf->next = right;
+
+    return right;
+  }
+
+  void insertSeparator(Path& path, Node* left, key_type separator, Node* right) //links right in after left, splitting every parent that overflows
+  {
+    while(true)
+    {
+      if(path.depth == 0)
+      {
+        Inner* newRoot = new Inner();
+        newRoot->keys[0] = std::move(separator);
+        newRoot->children[0] = left;
+        newRoot->children[1] = right;
+        newRoot->count = 1;
+        root = newRoot;
+        return;
+      }
+
+      path.depth--;
+      Inner* parent = path.nodes[path.depth];
+      size_type index = path.indices[path.depth];
+
+      for(size_type i = parent->count; i > index; i--)
+      {
+        parent->keys[i] = std::move(parent->keys[i - 1]);
+        parent->children[i + 1] = parent->children[i];
+      }
+      parent->keys[index] = std::move(separator);
+      parent->children[index + 1] = right;
+      parent->count++;
+
+      if(parent->count <= innerCapacity)
+        return;
+
+      //the middle key moves up, the keys and children right of it go to the new sibling
+      Inner* sibling = new Inner();
+      size_type middle = parent->count / 2;
+
+      separator = std::move(parent->keys[middle]);
+      for(size_type i = middle + 1; i < parent->count; i++)
+      {
+        sibling->keys[i - middle - 1] = std::move(parent->keys[i]);
+      }
+      for(size_type i = middle + 1; i <= parent->count; i++)
+      {
+        sibling->children[i - middle - 1] = parent->children[i];
+      }
+      sibling->count = parent->count - middle - 1;
+      parent->count = middle;
+
+      left = parent;
+      right = sibling;
+    }
+  }
+
+  template <typename K, typename... Args>
+  position tryEmplace(K&& key, Args&&... args) //position of the new entry, or of the existing one, args are then unused
+  {
+    if(root == nullptr)
+    {
+      Leaf* leaf = new Leaf();
+      root = leaf;
+      firstLeaf = leaf;
+      lastLeaf = leaf;
+    }
+
+    Path path;
+    Leaf* leaf = descend(key, &path);
+    size_type index = leafPosition(leaf, key);
+
+    if(index < leaf->count && !comp(key, leaf->at(index).first))
+      return position(leaf, index);
+
+    for(size_type i = leaf->count; i > index; i--)
+    {
+      moveSlot(leaf, i - 1, leaf, i);
+    }
+
+    try
+    {
+      new (leaf->slot(index)) value_type(std::piecewise_construct,
+                                         std::forward_as_tuple(std::forward<K>(key)),
+                                         std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    catch(...)
+    {
+      for(size_type i = index + 1; i <= leaf->count; i++)
+      {
+        moveSlot(leaf, i, leaf, i - 1);
+      }
+      throw;
+    }
+
+    leaf->count++;
+    size++;
+
+    if(leaf->count <= leafCapacity)
+      return position(leaf, index);
+
+    Leaf* right = splitLeaf(leaf);
+    insertSeparator(path, leaf, right->at(0).first, right);
+
+    if(index < leaf->count)
+      return position(leaf, index);
+
+    return position(right, index - leaf->count);
+  }
+
+  void mergeLeaves(Leaf* left, Leaf* right) //appends right to left and deletes it
+  {
+    for(size_type i = 0; i < right->count; i++)
+    {
+      moveSlot(right, i, left, left->count + i);
+    }
+    left->count += right->count;
+
+    left->next = right->next;
+    if(right->next != nullptr)
+      right->next->previous = left;
+    else
+      lastLeaf = left;
+
+    delete right;
+  }
+
+  static void mergeInner(Inner* left, key_type& separator, Inner* right) //appends the separator and right to left and deletes right
+  {
+    left->keys[left->count] = std::move(separator);
+    for(size_type i = 0; i < right->count; i++)
+    {
+      left->keys[left->count + 1 + i] = std::move(right->keys[i]);
+    }
+    for(size_type i = 0; i <= right->count; i++)
+    {
+      left->children[left->count + 1 + i] = right->children[i];
+    }
+    left->count += right->count + 1;
+
+    delete right;
+  }
+
+  void removeSeparator(Path& path, size_type keyIndex) //drops keys[keyIndex] and the child after it from the deepest node on path
+  {
+    while(true)
+    {
+      Inner* node = path.nodes[path.depth - 1];
+
+      for(size_type i = keyIndex; i + 1 < node->count; i++)
+      {
+        node->keys[i] = std::move(node->keys[i + 1]);
+        node->children[i + 1] = node->children[i + 2];
+      }
+      node->count--;
+      path.depth--;
+
+      if(path.depth == 0) //the root may go down to one child, which then replaces it
+      {
+        if(node->count == 0)
+        {
+          root = node->children[0];
+          delete node;
+        }
+        return;
+      }
+
+      if(node->count >= innerMinimum)
+        return;
+
+      Inner* parent = path.nodes[path.depth - 1];
+      size_type index = path.indices[path.depth - 1];
+      Inner* left = index > 0 ? static_cast<Inner*>(parent->children[index - 1]) : nullptr;
+      Inner* right = index < parent->count ? static_cast<Inner*>(parent->children[index + 1]) : nullptr;
+
+      if(left != nullptr && left->count > innerMinimum) //rotate left's last child over through the parent
+      {
+        node->children[node->count + 1] = node->children[node->count];
+        for(size_type i = node->count; i > 0; i--)
+        {
+          node->keys[i] = std::move(node->keys[i - 1]);
+          node->children[i] = node->children[i - 1];
+        }
+        node->keys[0] = std::move(parent->keys[index - 1]);
+        node->children[0] = left->children[left->count];
+        node->count++;
+
+        parent->keys[index - 1] = std::move(left->keys[left->count - 1]);
+        left->count--;
+        return;
+      }
+
+      if(right != nullptr && right->count > innerMinimum)
+      {
+        node->keys[node->count] = std::move(parent->keys[index]);
+        node->children[node->count + 1] = right->children[0];
+        node->count++;
+
+        parent->keys[index] = std::move(right->keys[0]);
+        for(size_type i = 0; i + 1 < right->count; i++)
+        {
+          right->keys[i] = std::move(right->keys[i + 1]);
+        }
+        for(size_type i = 0; i < right->count; i++)
+        {
+          right->children[i] = right->children[i + 1];
+        }
+        right->count--;
+        return;
+      }
+
+      if(left != nullptr)
+      {
+        mergeInner(left, parent->keys[index - 1], node);
+        keyIndex = index - 1;
+      }
+      else
+      {
+        mergeInner(node, parent->keys[index], right);
+        keyIndex = index;
+      }
+    }
+  }
+
+  void rebalanceLeaf(Path& path, Leaf* leaf) //leaf is below the minimum, borrow from a sibling or merge with one
+  {
+    Inner* parent = path.nodes[path.depth - 1];
+    size_type index = path.indices[path.depth - 1];
+    Leaf* left = index > 0 ? static_cast<Leaf*>(parent->children[index - 1]) : nullptr;
+    Leaf* right = index < parent->count ? static_cast<Leaf*>(parent->children[index + 1]) : nullptr;
+
+    if(left != nullptr && left->count > leafMinimum)
+    {
+      for(size_type i = leaf->count; i > 0; i--)
+      {
+        moveSlot(leaf, i - 1, leaf, i);
+      }
+      moveSlot(left, left->count - 1, leaf, 0);
+      left->count--;
+      leaf->count++;
+
+      parent->keys[index - 1] = leaf->at(0).first;
+    }
+    else if(right != nullptr && right->count > leafMinimum)
+    {
+      moveSlot(right, 0, leaf, leaf->count);
+      leaf->count++;
+      for(size_type i = 1; i < right->count; i++)
+      {
+        moveSlot(right, i, right, i - 1);
+      }
+      right->count--;
+
+      parent->keys[index] = right->at(0).first;
+    }
+    else if(left != nullptr)
+    {
+      mergeLeaves(left, leaf);
+      removeSeparator(path, index - 1);
+    }
+    else
+    {
+      mergeLeaves(leaf, right);
+      removeSeparator(path, index);
+    }
+  }
+
+  position eraseAt(Path& path, Leaf* leaf, size_type index) //path must lead to leaf, returns where the following entry ended up
+  {
+    bool rebalance = leaf != root && leaf->count - 1 < leafMinimum;
+    std::optional<key_type> removedKey;
+
+    //entries may move between leaves, the removed key finds the following one again afterwards
+    if(rebalance)
+      removedKey.emplace(leaf->at(index).first);
+
+    leaf->at(index).~value_type();
+    for(size_type i = index + 1; i < leaf->count; i++)
+    {
+      moveSlot(leaf, i, leaf, i - 1);
+    }
+    leaf->count--;
+    size--;
+
+    if(!rebalance)
+    {
+      if(leaf->count == 0) //the last entry of a root leaf
+      {
+        delete leaf;
+        root = nullptr;
+        firstLeaf = nullptr;
+        lastLeaf = nullptr;
+        return position(nullptr, 0);
+      }
+
+      return normalized(leaf, index);
+    }
+
+    rebalanceLeaf(path, leaf);
+
+    Leaf* following = descend(*removedKey, nullptr);
+    return normalized(following, leafPosition(following, *removedKey));
+  }
+
+  template <typename K>
+  void removeKey(const K& key)
+  {
+    if(root == nullptr)
+      throw std::out_of_range("Element not in collection. Cannot remove.");
+
+    Path path;
+    Leaf* leaf = descend(key, &path);
+    size_type index = leafPosition(leaf, key);
+
+    if(index == leaf->count || comp(key, leaf->at(index).first))
+      throw std::out_of_range("Element not in collection. Cannot remove.");
+
+    eraseAt(path, leaf, index);
+  }
+
+  void destroy(Node* current) //recursion depth is the tree height
+  {
+    if(current->leaf)
+    {
+      Leaf* leaf = static_cast<Leaf*>(current);
+
+      for(size_type i = 0; i < leaf->count; i++)
+      {
+        leaf->at(i).~value_type();
+      }
+      delete leaf;
+    }
+    else
+    {
+      Inner* inner = static_cast<Inner*>(current);
+
+      for(size_type i = 0; i <= inner->count; i++)
+      {
+        destroy(inner->children[i]);
+      }
+      delete inner;
+    }
+  }
+
+  Node* clone(const Node* other, Leaf*& previous) //previous is the last leaf cloned so far, the leaf links are rebuilt in order
+  {
+    if(other->leaf)
+    {
+      const Leaf* source = static_cast<const Leaf*>(other);
+      Leaf* leaf = new Leaf();
+
+      for(; leaf->count < source->count; leaf->count++)
+      {
+        new (leaf->slot(leaf->count)) value_type(source->at(leaf->count));
+      }
+
+      leaf->previous = previous;
+      if(previous != nullptr)
+        previous->next = leaf;
+      else
+        firstLeaf = leaf;
+      previous = leaf;
+      lastLeaf = leaf;
+
+      return leaf;
+    }
+
+    const Inner* source = static_cast<const Inner*>(other);
+    Inner* inner = new Inner();
+
+    for(size_type i = 0; i < source->count; i++)
+    {
+      inner->keys[i] = source->keys[i];
+    }
+    for(size_type i = 0; i <= source->count; i++)
+    {
+      inner->children[i] = clone(source->children[i], previous);
+    }
+    inner->count = source->count;
+
+    return inner;
+  }
+
+  void makeEmpty()
+  {
+    root = nullptr;
+    firstLeaf = nullptr;
+    lastLeaf = nullptr;
+    size = 0;
+  }
+
+  void removeAll()
+  {
+    if(root != nullptr)
+      destroy(root);
+
+    makeEmpty();
+  }
+
+  void copyFrom(const BTreeMap& other)
+  {
+    if(other.root != nullptr)
+    {
+      Leaf* previous = nullptr;
+      root = clone(other.root, previous);
+      size = other.size;
+    }
+  }
+
+public:
+  BTreeMap()
+  {
+    makeEmpty();
+  }
+
+  explicit BTreeMap(const key_compare& compare) : comp(compare)
+  {
+    makeEmpty();
+  }
+
+  BTreeMap(std::initializer_list<value_type> list)
+  {
+    makeEmpty();
+
+    for(auto it = list.begin(); it != list.end(); ++it)
+    {
+      tryEmplace(it->first, it->second);
+    }
+  }
+
+  BTreeMap(const BTreeMap& other) : comp(other.comp)
+  {
+    makeEmpty();
+    copyFrom(other);
+  }
+
+  BTreeMap(BTreeMap&& other) noexcept
+    : root(other.root), firstLeaf(other.firstLeaf), lastLeaf(other.lastLeaf), size(other.size), comp(std::move(other.comp))
+  {
+    other.makeEmpty();
+  }
+
+  ~BTreeMap()
+  {
+    removeAll();
+  }
+
+  BTreeMap& operator=(const BTreeMap& other)
+  {
+    if(this == &other)
+      return *this;
+
+    removeAll();
+    comp = other.comp;
+    copyFrom(other);
+
+    return *this;
+  }
+
+  BTreeMap& operator=(BTreeMap&& other) noexcept
+  {
+    if(this == &other)
+      return *this;
+
+    removeAll();
+    root = other.root;
+    firstLeaf = other.firstLeaf;
+    lastLeaf = other.lastLeaf;
+    size = other.size;
+    comp = std::move(other.comp);
+    other.makeEmpty();
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return size == 0;
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    position found = tryEmplace(key);
+    return found.first->at(found.second).second;
+  }
+
+  mapped_type& operator[](key_type&& key)
+  {
+    position found = tryEmplace(std::move(key));
+    return found.first->at(found.second).second;
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    ConstIterator it = find(key);
+    return it->second;
+  }
+
+  mapped_type& valueOf(const key_type& key)
+  {
+    Iterator it = find(key);
+    return it->second;
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  const mapped_type& valueOf(const K& key) const
+  {
+    ConstIterator it = find(key);
+    return it->second;
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  mapped_type& valueOf(const K& key)
+  {
+    Iterator it = find(key);
+    return it->second;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    position found = locate(key);
+    return ConstIterator(const_cast<BTreeMap*>(this), found.first, found.second);
+  }
+
+  iterator find(const key_type& key)
+  {
+    position found = locate(key);
+    return Iterator(this, found.first, found.second);
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  const_iterator find(const K& key) const //lookup by any type the comparator accepts, no key_type is built
+  {
+    position found = locate(key);
+    return ConstIterator(const_cast<BTreeMap*>(this), found.first, found.second);
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  iterator find(const K& key)
+  {
+    position found = locate(key);
+    return Iterator(this, found.first, found.second);
+  }
+
+  void remove(const key_type& key)
+  {
+    removeKey(key);
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  void remove(const K& key)
+  {
+    removeKey(key);
+  }
+
+  iterator remove(const const_iterator& it) //other iterators into the same leaf or its siblings are invalidated, continue from the returned one
+  {
+    if(it.leaf == nullptr)
+      throw std::out_of_range("Attempt to remove end iterator!");
+
+    Path path;
+    descend(it.leaf->at(it.index).first, &path);
+
+    position following = eraseAt(path, it.leaf, it.index);
+    return Iterator(this, following.first, following.second);
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  bool operator==(const BTreeMap& other) const
+  {
+    if(size != other.size)
+      return false;
+
+    //keys match when neither orders before the other, the comparator may not agree with key_type's operator==
+    for(auto it = cbegin(), itOther = other.cbegin(); it != cend(); ++it, ++itOther)
+    {
+      if(comp(it->first, itOther->first) || comp(itOther->first, it->first) || it->second != itOther->second)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const BTreeMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return Iterator(this, firstLeaf, 0);
+  }
+
+  iterator end()
+  {
+    return Iterator(this, nullptr, 0);
+  }
+
+  const_iterator cbegin() const
+  {
+    return ConstIterator(const_cast<BTreeMap*>(this), firstLeaf, 0);
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(const_cast<BTreeMap*>(this), nullptr, 0);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Compare>
+class BTreeMap<KeyType, ValueType, Compare>::ConstIterator
+{
+public:
+  using reference = typename BTreeMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename BTreeMap::value_type;
+  using pointer = const typename BTreeMap::value_type*;
+
+protected:
+  friend class BTreeMap;
+
+  BTreeMap* collection;
+  Leaf* leaf;         //nullptr for end()
+  size_type index;
+
+public:
+  explicit ConstIterator(BTreeMap* tree, Leaf* newLeaf, size_type newIndex)
+    : collection(tree), leaf(newLeaf), index(newIndex)
+  {}
+
+  ConstIterator() : collection(nullptr), leaf(nullptr), index(0)
+  {}
+
+  ConstIterator(const ConstIterator& other) = default;
+  ConstIterator& operator=(const ConstIterator& other) = default;
+
+  ConstIterator& operator++()
+  {
+    if(leaf == nullptr)
+      throw std::out_of_range("Attempt to reach past last element!");
+
+    if(++index == leaf->count)
+    {
+      leaf = leaf->next;
+      index = 0;
+    }
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator org = *this;
+    ++(*this);
+    return org;
+  }
+
+  ConstIterator& operator--()
+  {
+    Leaf* target = leaf == nullptr ? collection->lastLeaf : leaf;
+
+    if(leaf != nullptr && index > 0)
+    {
+      index--;
+      return *this;
+    }
+
+    if(leaf != nullptr)
+      target = leaf->previous;
+
+    if(target == nullptr)
+      throw std::out_of_range("Attempt to reach before first element!");
+
+    leaf = target;
+    index = target->count - 1;
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator org = *this;
+    --(*this);
+    return org;
+  }
+
+  reference operator*() const
+  {
+    if(leaf == nullptr)
+      throw std::out_of_range("Attempt to dereference end iterator!");
+
+    return leaf->at(index);
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return collection == other.collection && leaf == other.leaf && index == other.index;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Compare>
+class BTreeMap<KeyType, ValueType, Compare>::Iterator : public BTreeMap<KeyType, ValueType, Compare>::ConstIterator
+{
+public:
+  using reference = typename BTreeMap::reference;
+  using pointer = typename BTreeMap::value_type*;
+
+  explicit Iterator(BTreeMap* tree, Leaf* newLeaf, size_type newIndex)
+    : ConstIterator(tree, newLeaf, newIndex)
+  {}
+
+  Iterator() : ConstIterator()
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_BTREEMAP_H */
@@ -0,0 +1,50 @@
+#ifndef AISDI_MAPS_BITS_H
+#define AISDI_MAPS_BITS_H
+
+#include <cstdint>
+
+namespace aisdi
+{
+
+inline unsigned countTrailingZeros(std::uint64_t bits) //bits must be non-zero
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+  unsigned count = 0;
+  while((bits & 1u) == 0)
+  {
+    bits >>= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+inline unsigned countLeadingZeros(std::uint64_t bits) //bits must be non-zero
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_clzll(bits));
+#else
+  unsigned count = 0;
+  while((bits & (std::uint64_t(1) << 63)) == 0)
+  {
+    bits <<= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+inline void prefetchRead(const void* address) //a hint only, does nothing where the compiler has no prefetch builtin
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#else
+  (void)address;
+#endif
+}
+
+}
+
+#endif /* AISDI_MAPS_BITS_H */
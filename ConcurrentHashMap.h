@@ -0,0 +1,178 @@
+#ifndef AISDI_MAPS_CONCURRENTHASHMAP_H
+#define AISDI_MAPS_CONCURRENTHASHMAP_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include <functional>
+
+#include "Hash.h"
+#include "HashMap.h"
+
+namespace aisdi
+{
+
+  const size_t defaultShardCount = 64;
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class ConcurrentHashMap //independently locked HashMap shards, results are returned by value since iterators would outlive the lock
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+private:
+  struct alignas(64) Shard //own cache line, so neighbouring locks do not bounce between cores
+  {
+    mutable std::shared_mutex lock;
+    HashMap<key_type, mapped_type, hasher, key_equal> map;
+  };
+
+  std::unique_ptr<Shard[]> shards;
+  size_type shardCount;   //power of two
+  hasher hash;
+
+  Shard& shardFor(const key_type& key) const
+  {
+    //low bits pick the shard, the shard's own table reduces with the high bits
+    return shards[hash(key) & (shardCount - 1)];
+  }
+
+public:
+  explicit ConcurrentHashMap(size_type shardsWanted = defaultShardCount, const hasher& hashFunction = hasher())
+    : hash(hashFunction)
+  {
+    if(shardsWanted == 0)
+      throw std::invalid_argument("Shard count must be positive!");
+
+    shardCount = size_type(1) << log2Ceil(shardsWanted);
+    shards.reset(new Shard[shardCount]);
+  }
+
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  std::optional<mapped_type> find(const key_type& key) const
+  {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> guard(shard.lock);
+
+    auto it = shard.map.find(key);
+
+    if(it == shard.map.cend())
+      return std::nullopt;
+
+    return it->second;
+  }
+
+  bool contains(const key_type& key) const
+  {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> guard(shard.lock);
+
+    return shard.map.find(key) != shard.map.cend();
+  }
+
+  mapped_type valueOf(const key_type& key) const
+  {
+    std::optional<mapped_type> value = find(key);
+
+    if(!value)
+      throw std::out_of_range("Key not found!");
+
+    return *value;
+  }
+
+  template <typename M>
+  bool insert_or_assign(const key_type& key, M&& value) //true if the key was not present before
+  {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    return shard.map.insert_or_assign(key, std::forward<M>(value)).second;
+  }
+
+  template <typename... Args>
+  bool try_emplace(const key_type& key, Args&&... args) //true if inserted, an existing value is left alone
+  {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    return shard.map.try_emplace(key, std::forward<Args>(args)...).second;
+  }
+
+  bool remove(const key_type& key) //false if the key was not present
+  {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    auto it = shard.map.find(key);
+
+    if(it == shard.map.end())
+      return false;
+
+    shard.map.remove(it);
+    return true;
+  }
+
+  template <typename F>
+  mapped_type compute(const key_type& key, F fn) //fn updates the value in place under the shard lock, a missing key starts from mapped_type()
+  {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> guard(shard.lock);
+
+    mapped_type& value = (*shard.map.try_emplace(key).first).second;
+    fn(value);
+
+    return value;
+  }
+
+  template <typename F>
+  void forEach(F fn) const //visits one shard at a time, entries changed meanwhile in other shards may or may not be seen
+  {
+    for(size_type i = 0; i < shardCount; i++)
+    {
+      std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+
+      for(auto it = shards[i].map.cbegin(); it != shards[i].map.cend(); ++it)
+      {
+        fn(*it);
+      }
+    }
+  }
+
+  size_type getSize() const //exact only while no writer is running
+  {
+    size_type total = 0;
+
+    for(size_type i = 0; i < shardCount; i++)
+    {
+      std::shared_lock<std::shared_mutex> guard(shards[i].lock);
+      total += shards[i].map.getSize();
+    }
+
+    return total;
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  size_type getShardCount() const
+  {
+    return shardCount;
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_CONCURRENTHASHMAP_H */
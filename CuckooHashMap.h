@@ -0,0 +1,862 @@
+#ifndef AISDI_MAPS_CUCKOOHASHMAP_H
+#define AISDI_MAPS_CUCKOOHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <new>
+#include <functional>
+#include <vector>
+
+#include "Hash.h"
+
+namespace aisdi
+{
+
+  const size_t cuckooSlotsPerBucket = 4;
+  const size_t cuckooInitialBucketCount = 4;
+  const size_t cuckooMaxPath = 64;        //displacements tried before an entry goes to the stash
+  const size_t cuckooStashSize = 8;      //never grows, so a lookup never compares more than 8 + cuckooStashSize tags
+  const float cuckooMaxLoadFactor = 0.9f;
+  const float cuckooMinGrowthLoad = 0.5f;    //a table this empty that still overflows has colliding hashes, doubling would not part them
+  const std::uint64_t cuckooSeedStep = 0x9e3779b97f4a7c15ull;
+
+//every key lives in one of its two 4-slot buckets or in the small stash, so a lookup probes at most 8 slots plus the stash;
+//when four entries take at most 60 bytes a bucket is one cache line and a lookup outside the stash reads at most two lines,
+//bigger entries spill past the tag line, so a hit can read one more line holding the matching entry (three in all),
+//and a lookup that reaches a non-empty stash also reads the stash tags and any entry whose tag matches
+//an insert that finds no room even after reseeding the second hash and doubling the table throws std::length_error and
+//leaves the map unchanged, which takes keys whose hashes collide outright, not just a weak Hash
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class CuckooHashMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  struct alignas(64) Bucket //tags come first, so a miss reads only the tag line and a hit at most the line or two holding its entry
+  {
+    unsigned char tags[cuckooSlotsPerBucket];   //0 for an empty slot, otherwise a non-zero byte of the key's hash
+    alignas(value_type) unsigned char storage[cuckooSlotsPerBucket * sizeof(value_type)];
+
+    value_type* slot(size_type index)
+    {
+      return reinterpret_cast<value_type*>(storage) + index;
+    }
+
+    value_type& at(size_type index)
+    {
+      return *std::launder(slot(index));
+    }
+  };
+
+  Bucket* buckets;          //slot index i is slot i % cuckooSlotsPerBucket of bucket i / cuckooSlotsPerBucket
+  value_type* stash;        //entries that found no room after cuckooMaxPath displacements
+  unsigned char* stashTags; //tag of each stash entry, checked before the key is compared
+  size_type stashSize;
+  size_type bucketCount;    //always a power of two
+  unsigned shift;
+  std::uint64_t seed;       //mixed into the second hash only, changed when the stash overflows
+  size_type size;
+  size_type victim;         //rotates the slot evicted on each displacement so paths do not cycle
+  hasher hash;
+  key_equal equal;
+
+  struct Position //both candidate buckets and the tag of one key
+  {
+    size_type first;
+    size_type second;
+    unsigned char tag;
+  };
+
+  size_type capacity() const
+  {
+    return bucketCount * cuckooSlotsPerBucket;
+  }
+
+  size_type endIndex() const //iterator positions cover the slots, then the stash
+  {
+    return capacity() + cuckooStashSize;
+  }
+
+  static Position positionFor(std::uint64_t keyHash, unsigned tableShift, std::uint64_t tableSeed)
+  {
+    std::uint64_t mixed = keyHash ^ tableSeed;
+    std::uint64_t other = (mixed ^ (mixed >> 31)) * 0xbf58476d1ce4e5b9ull; //second, independent mix of the same hash
+
+    Position position;
+    position.first = fibonacciIndex(keyHash, tableShift);
+    position.second = static_cast<size_type>((other ^ (other >> 27)) >> tableShift);
+    position.tag = static_cast<unsigned char>(keyHash & 0xFF);
+
+    if(position.second == position.first)
+      position.second ^= 1;
+    if(position.tag == 0)
+      position.tag = 1;
+
+    return position;
+  }
+
+  Position positionOf(const key_type& key) const
+  {
+    return positionFor(static_cast<std::uint64_t>(hash(key)), shift, seed);
+  }
+
+  value_type& slotAt(size_type index) const
+  {
+    return buckets[index / cuckooSlotsPerBucket].at(index % cuckooSlotsPerBucket);
+  }
+
+  unsigned char& tagAt(size_type index) const
+  {
+    return buckets[index / cuckooSlotsPerBucket].tags[index % cuckooSlotsPerBucket];
+  }
+
+  size_type findIn(size_type bucket, const key_type& key, unsigned char tag) const //returns capacity() if key is not in bucket
+  {
+    Bucket& candidates = buckets[bucket];
+
+    for(size_type i = 0; i < cuckooSlotsPerBucket; i++)
+    {
+      if(candidates.tags[i] == tag && equal(candidates.at(i).first, key))
+        return bucket * cuckooSlotsPerBucket + i;
+    }
+
+    return capacity();
+  }
+
+  size_type findSlot(const key_type& key) const //returns endIndex() if key is not present
+  {
+    if(size == 0)   //also covers a moved-from map, which has no table
+      return endIndex();
+
+    Position position = positionOf(key);
+    size_type index = findIn(position.first, key, position.tag);
+
+    if(index == capacity())
+      index = findIn(position.second, key, position.tag);
+
+    if(index != capacity())
+      return index;
+
+    for(size_type i = 0; i < stashSize; i++)
+    {
+      if(stashTags[i] == position.tag && equal(stash[i].first, key))
+        return capacity() + i;
+    }
+
+    return endIndex();
+  }
+
+  size_type freeIn(size_type bucket) const //returns capacity() if bucket is full
+  {
+    for(size_type i = 0; i < cuckooSlotsPerBucket; i++)
+    {
+      if(buckets[bucket].tags[i] == 0)
+        return bucket * cuckooSlotsPerBucket + i;
+    }
+
+    return capacity();
+  }
+
+  void allocate(size_type newBucketCount)
+  {
+    bucketCount = newBucketCount < cuckooInitialBucketCount ? cuckooInitialBucketCount : newBucketCount;
+    shift = 64 - log2Ceil(bucketCount);
+    buckets = static_cast<Bucket*>(::operator new(bucketCount * sizeof(Bucket), std::align_val_t(alignof(Bucket))));
+    for(size_type b = 0; b < bucketCount; b++)
+    {
+      new (buckets + b) Bucket;
+      std::fill(buckets[b].tags, buckets[b].tags + cuckooSlotsPerBucket, 0);
+    }
+
+    stash = std::allocator<value_type >().allocate(cuckooStashSize);
+    stashTags = new unsigned char[cuckooStashSize];
+    stashSize = 0;
+  }
+
+  void release()
+  {
+    releaseTable(buckets, bucketCount, stash, stashTags, stashSize);
+  }
+
+  static void releaseTable(Bucket* table, size_type tableBuckets, value_type* entries, unsigned char* entryTags, size_type entryCount)
+  {
+    if(table == nullptr)
+      return;
+
+    for(size_type b = 0; b < tableBuckets; b++)
+    {
+      for(size_type i = 0; i < cuckooSlotsPerBucket; i++)
+      {
+        if(table[b].tags[i] != 0)
+          table[b].at(i).~value_type();
+      }
+    }
+
+    for(size_type i = 0; i < entryCount; i++)
+    {
+      entries[i].~value_type();
+    }
+
+    ::operator delete(table, std::align_val_t(alignof(Bucket)));
+    std::allocator<value_type >().deallocate(entries, cuckooStashSize);
+    delete[] entryTags;
+  }
+
+  static size_type plannedFreeIn(const std::vector<size_type>& planned, size_type bucket, size_type empty) //returns planned.size() if bucket is full
+  {
+    for(size_type i = bucket * cuckooSlotsPerBucket; i < (bucket + 1) * cuckooSlotsPerBucket; i++)
+    {
+      if(planned[i] == empty)
+        return i;
+    }
+
+    return planned.size();
+  }
+
+  //lays out entries 0..hashes.size() - 1 by number only, the same walk place() does on the live table;
+  //false if one of them finds neither a slot nor room in the stash
+  static bool plan(const std::vector<std::uint64_t>& hashes, unsigned tableShift, std::uint64_t tableSeed,
+                   std::vector<size_type>& planned, std::vector<size_type>& stashed)
+  {
+    size_type empty = hashes.size();
+    size_type turn = 0;
+
+    for(size_type entry = 0; entry < hashes.size(); entry++)
+    {
+      size_type homeless = entry;
+      Position position = positionFor(hashes[homeless], tableShift, tableSeed);
+      size_type bucket = position.first;
+      size_type index = plannedFreeIn(planned, position.first, empty);
+
+      if(index == planned.size())
+        index = plannedFreeIn(planned, position.second, empty);
+
+      for(size_type step = 0; index == planned.size() && step < cuckooMaxPath; step++)
+      {
+        size_type evicted = bucket * cuckooSlotsPerBucket + turn++ % cuckooSlotsPerBucket;
+        std::swap(planned[evicted], homeless);
+
+        Position evictedPosition = positionFor(hashes[homeless], tableShift, tableSeed);
+        bucket = evictedPosition.first == bucket ? evictedPosition.second : evictedPosition.first;
+        index = plannedFreeIn(planned, bucket, empty);
+      }
+
+      if(index != planned.size())
+        planned[index] = homeless;
+      else if(stashed.size() < cuckooStashSize)
+        stashed.push_back(homeless);
+      else
+        return false;
+    }
+
+    return true;
+  }
+
+  //moves every entry and extra into a table of newBucketCount buckets hashed with newSeed, returns extra's index there;
+  //the layout is planned first, so when the keys do not fit it returns endIndex() and nothing has changed
+  size_type rehash(size_type newBucketCount, std::uint64_t newSeed, value_type& extra)
+  {
+    newBucketCount = newBucketCount < cuckooInitialBucketCount ? cuckooInitialBucketCount : newBucketCount;
+
+    std::vector<value_type*> sources;   //extra is the last one
+    sources.reserve(size + 1);
+    for(size_type index = firstFrom(0); index != endIndex(); index = firstFrom(index + 1))
+    {
+      sources.push_back(&entryAt(index));
+    }
+    sources.push_back(&extra);
+
+    std::vector<std::uint64_t> hashes(sources.size());
+    for(size_type entry = 0; entry < sources.size(); entry++)
+    {
+      hashes[entry] = static_cast<std::uint64_t>(hash(sources[entry]->first));
+    }
+
+    unsigned newShift = 64 - log2Ceil(newBucketCount);
+    std::vector<size_type> planned(newBucketCount * cuckooSlotsPerBucket, sources.size());
+    std::vector<size_type> stashed;
+
+    if(!plan(hashes, newShift, newSeed, planned, stashed))
+      return endIndex();
+
+    Bucket* oldBuckets = buckets;
+    size_type oldBucketCount = bucketCount;
+    value_type* oldStash = stash;
+    unsigned char* oldStashTags = stashTags;
+    size_type oldStashSize = stashSize;
+    size_type placed = 0;
+
+    allocate(newBucketCount);
+    seed = newSeed;
+    size = 0;
+
+    for(size_type index = 0; index < planned.size(); index++)
+    {
+      if(planned[index] == sources.size())
+        continue;
+
+      placeAt(index, positionFor(hashes[planned[index]], shift, seed).tag, std::move(*sources[planned[index]]));
+
+      if(planned[index] == sources.size() - 1)
+        placed = index;
+    }
+
+    for(size_type entry : stashed)
+    {
+      new (stash + stashSize) value_type(std::move(*sources[entry]));
+      stashTags[stashSize] = positionFor(hashes[entry], shift, seed).tag;
+
+      if(entry == sources.size() - 1)
+        placed = capacity() + stashSize;
+
+      stashSize++;
+      size++;
+    }
+
+    releaseTable(oldBuckets, oldBucketCount, oldStash, oldStashTags, oldStashSize);  //the old entries are moved-from, only destroyed
+    return placed;
+  }
+
+  size_type placeAt(size_type index, unsigned char tag, value_type&& val)
+  {
+    new (buckets[index / cuckooSlotsPerBucket].slot(index % cuckooSlotsPerBucket)) value_type(std::move(val));
+    tagAt(index) = tag;
+    size++;
+    return index;
+  }
+
+  //key must be absent, returns the index val ended up at; endIndex() if the path and the stash are used up,
+  //every displaced resident is then back in place and val is untouched
+  size_type place(value_type& val)
+  {
+    Position position = positionOf(val.first);
+    size_type index = freeIn(position.first);
+
+    if(index == capacity())
+      index = freeIn(position.second);
+
+    if(index != capacity())
+      return placeAt(index, position.tag, std::move(val));
+
+    //both buckets are full, walk a bounded path evicting residents into their other bucket
+    size_type path[cuckooMaxPath];
+    unsigned char homelessTag = position.tag;
+    size_type bucket = position.first;
+    size_type result = capacity();    //where the new entry is, capacity() while it is the homeless one
+
+    for(size_type step = 0; step < cuckooMaxPath; step++)
+    {
+      size_type evicted = bucket * cuckooSlotsPerBucket + victim++ % cuckooSlotsPerBucket;
+
+      path[step] = evicted;
+      std::swap(slotAt(evicted), val);
+      std::swap(tagAt(evicted), homelessTag);
+
+      if(result == capacity())
+        result = evicted;
+      else if(result == evicted)
+        result = capacity();
+
+      Position evictedPosition = positionOf(val.first);
+      bucket = evictedPosition.first == bucket ? evictedPosition.second : evictedPosition.first;
+      index = freeIn(bucket);
+
+      if(index != capacity())
+      {
+        placeAt(index, homelessTag, std::move(val));
+        return result == capacity() ? index : result;
+      }
+    }
+
+    //undo the path in reverse, which hands the new entry back to val
+    for(size_type step = cuckooMaxPath; step > 0; step--)
+    {
+      std::swap(slotAt(path[step - 1]), val);
+      std::swap(tagAt(path[step - 1]), homelessTag);
+    }
+
+    if(stashSize == cuckooStashSize)
+      return endIndex();
+
+    new (stash + stashSize) value_type(std::move(val));
+    stashTags[stashSize] = homelessTag;
+    size++;
+    return capacity() + stashSize++;
+  }
+
+  size_type insert(value_type val) //key must be absent, returns its index
+  {
+    bool crowded = size + 1 > capacity() * cuckooMaxLoadFactor;   //always true for a moved-from map, which has no buckets
+    bool sparse = size + 1 <= capacity() * cuckooMinGrowthLoad;
+    size_type index = crowded ? endIndex() : place(val);
+    std::uint64_t reseeded = seed + cuckooSeedStep;
+
+    //a full stash means colliding hashes, a new second hash at the same size may part them without growing
+    if(index == endIndex() && !crowded)
+      index = rehash(bucketCount, reseeded, val);
+    if(index == endIndex() && !sparse)
+      index = rehash(bucketCount * 2, seed, val);
+    if(index == endIndex() && !sparse)
+      index = rehash(bucketCount * 2, reseeded, val);
+    if(index == endIndex())
+      throw std::length_error("Too many keys share both of their buckets!");
+
+    return index;
+  }
+
+  void removeSlot(size_type index)
+  {
+    if(index < capacity())
+    {
+      slotAt(index).~value_type();
+      tagAt(index) = 0;
+    }
+    else
+    {
+      //the last stash entry fills the hole, so the stash stays contiguous
+      value_type* hole = stash + (index - capacity());
+      value_type* last = stash + stashSize - 1;
+
+      if(hole != last)
+      {
+        *hole = std::move(*last);
+        stashTags[index - capacity()] = stashTags[stashSize - 1];
+      }
+
+      last->~value_type();
+      stashSize--;
+    }
+
+    size--;
+  }
+
+  size_type firstFrom(size_type index) const //first full slot or stash entry at or after index
+  {
+    for(; index < capacity(); index++)
+    {
+      if(tagAt(index) != 0)
+        return index;
+    }
+
+    return index < capacity() + stashSize ? index : endIndex();
+  }
+
+  size_type lastBefore(size_type index) const //last full position before index, endIndex() if there is none
+  {
+    if(index > capacity() + stashSize)
+      index = capacity() + stashSize;
+
+    if(index > capacity())
+      return index - 1;
+
+    while(index > 0)
+    {
+      if(tagAt(--index) != 0)
+        return index;
+    }
+
+    return endIndex();
+  }
+
+  value_type& entryAt(size_type index) const
+  {
+    return index < capacity() ? slotAt(index) : stash[index - capacity()];
+  }
+
+public:
+  CuckooHashMap() : seed(0), size(0), victim(0)
+  {
+    allocate(cuckooInitialBucketCount);
+  }
+
+  explicit CuckooHashMap(const hasher& hashFunction, const key_equal& keyEqual = key_equal())
+    : seed(0), size(0), victim(0), hash(hashFunction), equal(keyEqual)
+  {
+    allocate(cuckooInitialBucketCount);
+  }
+
+  CuckooHashMap(std::initializer_list<value_type> list) : seed(0), size(0), victim(0)
+  {
+    allocate(cuckooInitialBucketCount);
+
+    for(auto it = list.begin(); it != list.end(); ++it)
+    {
+      if(findSlot(it->first) == endIndex())
+        insert(*it);
+    }
+  }
+
+  CuckooHashMap(const CuckooHashMap& other) : seed(other.seed), size(0), victim(0), hash(other.hash), equal(other.equal)
+  {
+    allocate(other.bucketCount);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+  }
+
+  CuckooHashMap(CuckooHashMap&& other) noexcept : hash(other.hash), equal(other.equal)
+  {
+    buckets = other.buckets;
+    stash = other.stash;
+    stashTags = other.stashTags;
+    stashSize = other.stashSize;
+    bucketCount = other.bucketCount;
+    shift = other.shift;
+    seed = other.seed;
+    size = other.size;
+    victim = other.victim;
+
+    //the moved-from map keeps no table and allocates one on its first insert, so nothing here can throw
+    other.buckets = nullptr;
+    other.stash = nullptr;
+    other.stashTags = nullptr;
+    other.stashSize = 0;
+    other.bucketCount = 0;
+    other.size = 0;
+  }
+
+  ~CuckooHashMap()
+  {
+    release();
+  }
+
+  CuckooHashMap& operator=(const CuckooHashMap& other)
+  {
+    if(this == &other)
+      return *this;
+
+    release();
+    size = 0;
+    seed = other.seed;
+    hash = other.hash;
+    equal = other.equal;
+    allocate(other.bucketCount);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+
+    return *this;
+  }
+
+  CuckooHashMap& operator=(CuckooHashMap&& other) noexcept
+  {
+    if(this == &other)
+      return *this;
+
+    std::swap(buckets, other.buckets);
+    std::swap(stash, other.stash);
+    std::swap(stashTags, other.stashTags);
+    std::swap(stashSize, other.stashSize);
+    std::swap(bucketCount, other.bucketCount);
+    std::swap(shift, other.shift);
+    std::swap(seed, other.seed);
+    std::swap(size, other.size);
+    std::swap(victim, other.victim);
+    std::swap(hash, other.hash);
+    std::swap(equal, other.equal);
+
+    return *this;
+  }
+
+  hasher hash_function() const
+  {
+    return hash;
+  }
+
+  key_equal key_eq() const
+  {
+    return equal;
+  }
+
+  bool isEmpty() const
+  {
+    return size == 0;
+  }
+
+  size_type getStashSize() const
+  {
+    return stashSize;
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      index = insert(value_type(key, mapped_type()));
+
+    return entryAt(index).second;
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Key not found!");
+
+    return entryAt(index).second;
+  }
+
+  mapped_type& valueOf(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Key not found!");
+
+    return entryAt(index).second;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    return ConstIterator(const_cast<CuckooHashMap *>(this), findSlot(key));
+  }
+
+  iterator find(const key_type& key)
+  {
+    return Iterator(this, findSlot(key));
+  }
+
+  void remove(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Attempt to remove by wrong key!");
+
+    removeSlot(index);
+  }
+
+  iterator remove(const const_iterator& it) //returns the element after it, a stash removal pulls the last stash entry into its place
+  {
+    if(it == cend())
+      throw std::out_of_range("Attempt to remove end iterator!");
+
+    removeSlot(it.index);
+
+    return Iterator(this, firstFrom(it.index < capacity() ? it.index + 1 : it.index));
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  bool operator==(const CuckooHashMap& other) const
+  {
+    if(size != other.size)
+      return false;
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      size_type index = findSlot(it->first);
+
+      if(index == endIndex() || entryAt(index).second != it->second)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const CuckooHashMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return Iterator(this, firstFrom(0));
+  }
+
+  iterator end()
+  {
+    return Iterator(this, endIndex());
+  }
+
+  const_iterator cbegin() const
+  {
+    return ConstIterator(const_cast<CuckooHashMap *>(this), firstFrom(0));
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(const_cast<CuckooHashMap *>(this), endIndex());
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class CuckooHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename CuckooHashMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename CuckooHashMap::value_type;
+  using pointer = const typename CuckooHashMap::value_type*;
+
+protected:
+  friend class CuckooHashMap;
+
+  CuckooHashMap* collection;
+  size_type index;
+
+public:
+  explicit ConstIterator(CuckooHashMap* coll, size_type newIndex)
+    : collection(coll), index(newIndex)
+  {}
+
+  ConstIterator() : collection(nullptr), index(0)
+  {}
+
+  ConstIterator(const ConstIterator& other) = default;
+  ConstIterator& operator=(const ConstIterator& other) = default;
+
+  ConstIterator& operator++()
+  {
+    if(index == collection->endIndex())
+      throw std::out_of_range("Attempt to reach past end iterator!");
+
+    index = collection->firstFrom(index + 1);
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator org = *this;
+    ++(*this);
+    return org;
+  }
+
+  ConstIterator& operator--()
+  {
+    size_type previous = collection->lastBefore(index);
+
+    if(previous == collection->endIndex())
+      throw std::out_of_range("Attempt to reach before first element!");
+
+    index = previous;
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator org = *this;
+    --(*this);
+    return org;
+  }
+
+  reference operator*() const
+  {
+    if(index == collection->endIndex())
+      throw std::out_of_range("Attempt to dereference end iterator!");
+
+    return collection->entryAt(index);
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return collection == other.collection && index == other.index;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class CuckooHashMap<KeyType, ValueType, Hash, KeyEqual>::Iterator : public CuckooHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename CuckooHashMap::reference;
+  using pointer = typename CuckooHashMap::value_type*;
+
+  explicit Iterator(CuckooHashMap* coll, size_type newIndex)
+    : ConstIterator(coll, newIndex)
+  {}
+
+  Iterator() : ConstIterator()
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_CUCKOOHASHMAP_H */
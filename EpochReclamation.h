@@ -0,0 +1,129 @@
+#ifndef AISDI_MAPS_EPOCHRECLAMATION_H
+#define AISDI_MAPS_EPOCHRECLAMATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace aisdi
+{
+
+  const size_t epochMaxThreads = 256;
+  const std::uint64_t epochIdle = ~std::uint64_t(0);
+
+class EpochDomain //process wide epoch based reclamation, readers announce the epoch they entered in
+{
+private:
+  struct alignas(64) Slot
+  {
+    std::atomic<std::uint64_t> epoch;
+    std::atomic<bool> taken;
+  };
+
+  class ThreadSlot //claims a slot for the lifetime of the calling thread
+  {
+  public:
+    Slot* slot;
+    std::size_t depth;    //nested guards only announce once
+
+    explicit ThreadSlot(EpochDomain& domain) : slot(nullptr), depth(0)
+    {
+      for(std::size_t i = 0; i < epochMaxThreads && slot == nullptr; i++)
+      {
+        bool expected = false;
+
+        if(domain.slots[i].taken.compare_exchange_strong(expected, true))
+          slot = &domain.slots[i];
+      }
+
+      if(slot == nullptr)
+        throw std::runtime_error("Too many threads reading epoch protected data!");
+    }
+
+    ~ThreadSlot()
+    {
+      slot->epoch.store(epochIdle, std::memory_order_release);
+      slot->taken.store(false, std::memory_order_release);
+    }
+  };
+
+  Slot slots[epochMaxThreads];
+  std::atomic<std::uint64_t> globalEpoch;
+
+  EpochDomain() : globalEpoch(1)
+  {
+    for(std::size_t i = 0; i < epochMaxThreads; i++)
+    {
+      slots[i].epoch.store(epochIdle);
+      slots[i].taken.store(false);
+    }
+  }
+
+  ThreadSlot& threadSlot()
+  {
+    thread_local ThreadSlot current(*this);
+    return current;
+  }
+
+public:
+  class Guard //while alive, nothing retired after the guard was entered is freed
+  {
+  private:
+    ThreadSlot& current;
+
+  public:
+    Guard() : current(instance().threadSlot())
+    {
+      if(current.depth++ == 0)
+        current.slot->epoch.store(instance().globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+
+    ~Guard()
+    {
+      if(--current.depth == 0)
+        current.slot->epoch.store(epochIdle, std::memory_order_release);
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+  };
+
+  static EpochDomain& instance()
+  {
+    static EpochDomain domain;
+    return domain;
+  }
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  std::uint64_t retireEpoch() //call after unlinking, then advance() before asking what is safe to free
+  {
+    return globalEpoch.load(std::memory_order_seq_cst);
+  }
+
+  void advance()
+  {
+    globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  std::uint64_t oldestActive() const //anything retired in an earlier epoch is unreachable by every reader
+  {
+    std::uint64_t oldest = globalEpoch.load(std::memory_order_seq_cst);
+
+    for(std::size_t i = 0; i < epochMaxThreads; i++)
+    {
+      std::uint64_t epoch = slots[i].epoch.load(std::memory_order_seq_cst);
+
+      if(epoch < oldest)
+        oldest = epoch;
+    }
+
+    return oldest;
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_EPOCHRECLAMATION_H */
@@ -0,0 +1,401 @@
+#ifndef AISDI_MAPS_FROZENHASHMAP_H
+#define AISDI_MAPS_FROZENHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "Hash.h"
+
+namespace aisdi
+{
+
+  const size_t frozenKeysPerBucket = 4;     //average keys sharing one pilot
+  const size_t frozenSlackDivisor = 64;     //the table has n + n / 64 + 1 slots, the extra ones are remapped below n
+  const std::uint64_t frozenMaxSeeds = 64;
+  const std::uint32_t frozenMaxPilot = 65535;
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class FrozenHashMap //read-only map over a minimal perfect hash, a key's bucket pilot gives the one slot it can be in
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using const_reference = const value_type&;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+  using iterator = const_iterator;
+
+private:
+  std::vector<value_type> entries;    //entries[slotOf(key)], dense, in slot order
+  std::vector<std::uint16_t> pilots;  //one per bucket, chosen so the bucket's keys land on free, distinct slots
+  std::vector<std::uint32_t> remap;   //slot entries.size() + i is stored at remap[i]
+  std::uint64_t seed;
+  size_type tableSize;
+  hasher hash;
+  key_equal equal;
+
+  size_type bucketOf(std::uint64_t keyHash) const
+  {
+    return rangeIndex(mix64(keyHash ^ seed), pilots.size());
+  }
+
+  std::uint64_t positionHash(std::uint64_t keyHash) const
+  {
+    return mix64(keyHash ^ seed ^ 0x9e3779b97f4a7c15ull);
+  }
+
+  size_type slotFor(std::uint64_t position, std::uint32_t pilot) const //before remapping
+  {
+    return rangeIndex(position ^ mix64(pilot), tableSize);
+  }
+
+  size_type slotOf(const key_type& key) const
+  {
+    std::uint64_t keyHash = static_cast<std::uint64_t>(hash(key));
+    size_type slot = slotFor(positionHash(keyHash), pilots[bucketOf(keyHash)]);
+
+    return slot < entries.size() ? slot : remap[slot - entries.size()];
+  }
+
+  static std::vector<value_type> withoutDuplicates(std::vector<value_type>&& items, std::vector<std::uint64_t>& hashes,
+                                                   const hasher& hashFunction, const key_equal& keyEqual)
+  {
+    std::vector<size_type> order(items.size());
+
+    hashes.resize(items.size());
+    for(size_type i = 0; i < items.size(); i++)
+    {
+      hashes[i] = static_cast<std::uint64_t>(hashFunction(items[i].first));
+      order[i] = i;
+    }
+
+    //equal keys end up next to each other, the first occurrence wins as in the other maps' initializer lists
+    std::sort(order.begin(), order.end(), [&hashes](size_type a, size_type b)
+    {
+      return hashes[a] != hashes[b] ? hashes[a] < hashes[b] : a < b;
+    });
+
+    std::vector<bool> dropped(items.size(), false);
+    for(size_type group = 0; group < order.size(); )
+    {
+      size_type groupEnd = group + 1;
+
+      while(groupEnd < order.size() && hashes[order[groupEnd]] == hashes[order[group]])
+      {
+        groupEnd++;
+      }
+
+      for(size_type i = group + 1; i < groupEnd; i++)
+      {
+        if(!keyEqual(items[order[i]].first, items[order[group]].first))
+          throw std::invalid_argument("Distinct keys with identical hashes cannot be perfectly hashed!");
+
+        dropped[order[i]] = true;
+      }
+
+      group = groupEnd;
+    }
+
+    std::vector<value_type> unique;
+    std::vector<std::uint64_t> uniqueHashes;
+
+    unique.reserve(items.size());
+    uniqueHashes.reserve(items.size());
+    for(size_type i = 0; i < items.size(); i++)
+    {
+      if(!dropped[i])
+      {
+        unique.push_back(std::move(items[i]));
+        uniqueHashes.push_back(hashes[i]);
+      }
+    }
+
+    hashes.swap(uniqueHashes);
+    return unique;
+  }
+
+  bool place(const std::vector<std::uint64_t>& hashes, std::vector<size_type>& slots) //pilot search for the current seed, false if a bucket ran out of pilots
+  {
+    size_type count = hashes.size();
+    size_type bucketCount = pilots.size();
+
+    //counting sort of the keys by bucket
+    std::vector<size_type> bucketStart(bucketCount + 1, 0);
+    std::vector<size_type> keys(count);
+
+    for(size_type i = 0; i < count; i++)
+    {
+      bucketStart[bucketOf(hashes[i]) + 1]++;
+    }
+    for(size_type b = 0; b < bucketCount; b++)
+    {
+      bucketStart[b + 1] += bucketStart[b];
+    }
+
+    std::vector<size_type> cursor(bucketStart.begin(), bucketStart.end() - 1);
+    for(size_type i = 0; i < count; i++)
+    {
+      keys[cursor[bucketOf(hashes[i])]++] = i;
+    }
+
+    //largest buckets first, while the table is still empty enough for them
+    std::vector<size_type> bucketOrder(bucketCount);
+    for(size_type b = 0; b < bucketCount; b++)
+    {
+      bucketOrder[b] = b;
+    }
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&bucketStart](size_type a, size_type b)
+    {
+      return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    std::vector<bool> taken(tableSize, false);
+    std::vector<std::uint64_t> positions;
+    std::vector<size_type> candidate;
+
+    for(size_type b : bucketOrder)
+    {
+      size_type first = bucketStart[b];
+      size_type last = bucketStart[b + 1];
+
+      if(first == last)
+        break;
+
+      positions.clear();
+      for(size_type i = first; i < last; i++)
+      {
+        positions.push_back(positionHash(hashes[keys[i]]));
+      }
+
+      bool placed = false;
+      for(std::uint32_t pilot = 0; pilot <= frozenMaxPilot && !placed; pilot++)
+      {
+        candidate.clear();
+        placed = true;
+
+        for(size_type i = 0; i < positions.size() && placed; i++)
+        {
+          size_type slot = slotFor(positions[i], pilot);
+
+          placed = !taken[slot] && std::find(candidate.begin(), candidate.end(), slot) == candidate.end();
+          candidate.push_back(slot);
+        }
+
+        if(placed)
+        {
+          pilots[b] = static_cast<std::uint16_t>(pilot);
+
+          for(size_type i = 0; i < candidate.size(); i++)
+          {
+            taken[candidate[i]] = true;
+            slots[keys[first + i]] = candidate[i];
+          }
+        }
+      }
+
+      if(!placed)
+        return false;
+    }
+
+    //slots past the last entry are moved onto the slots below it that no key hashed to
+    remap.assign(tableSize - count, 0);
+    size_type hole = 0;
+
+    for(size_type slot = count; slot < tableSize; slot++)
+    {
+      if(taken[slot])
+      {
+        while(taken[hole])
+        {
+          hole++;
+        }
+
+        remap[slot - count] = static_cast<std::uint32_t>(hole);
+        taken[hole] = true;
+      }
+    }
+
+    for(size_type i = 0; i < count; i++)
+    {
+      if(slots[i] >= count)
+        slots[i] = remap[slots[i] - count];
+    }
+
+    return true;
+  }
+
+  void build(std::vector<value_type>&& items)
+  {
+    std::vector<std::uint64_t> hashes;
+    std::vector<value_type> unique = withoutDuplicates(std::move(items), hashes, hash, equal);
+    size_type count = unique.size();
+
+    seed = 0;
+    tableSize = 0;
+    pilots.clear();
+    remap.clear();
+    entries.clear();
+
+    if(count == 0)
+      return;
+
+    tableSize = count + count / frozenSlackDivisor + 1;
+    pilots.assign((count + frozenKeysPerBucket - 1) / frozenKeysPerBucket, 0);
+
+    std::vector<size_type> slots(count);
+
+    while(!place(hashes, slots))
+    {
+      if(++seed == frozenMaxSeeds)
+        throw std::runtime_error("No perfect hash found for the key set!");
+    }
+
+    std::vector<size_type> keyAt(count);
+    for(size_type i = 0; i < count; i++)
+    {
+      keyAt[slots[i]] = i;
+    }
+
+    entries.reserve(count);
+    for(size_type slot = 0; slot < count; slot++)
+    {
+      entries.push_back(std::move(unique[keyAt[slot]]));
+    }
+  }
+
+public:
+  explicit FrozenHashMap(const hasher& hashFunction = hasher(), const key_equal& keyEqual = key_equal())
+    : seed(0), tableSize(0), hash(hashFunction), equal(keyEqual)
+  {}
+
+  template <typename InputIt>
+  FrozenHashMap(InputIt first, InputIt last, const hasher& hashFunction = hasher(), const key_equal& keyEqual = key_equal())
+    : hash(hashFunction), equal(keyEqual)
+  {
+    std::vector<value_type> items;
+
+    for(; first != last; ++first)
+    {
+      items.emplace_back(first->first, first->second);
+    }
+
+    build(std::move(items));
+  }
+
+  template <typename Map, typename = decltype(std::declval<const Map&>().cbegin())>
+  explicit FrozenHashMap(const Map& map, const hasher& hashFunction = hasher(), const key_equal& keyEqual = key_equal())
+    : FrozenHashMap(map.cbegin(), map.cend(), hashFunction, keyEqual)
+  {}
+
+  FrozenHashMap(std::initializer_list<value_type> list)
+    : FrozenHashMap(list.begin(), list.end())
+  {}
+
+  hasher hash_function() const
+  {
+    return hash;
+  }
+
+  key_equal key_eq() const
+  {
+    return equal;
+  }
+
+  bool isEmpty() const
+  {
+    return entries.empty();
+  }
+
+  size_type getSize() const
+  {
+    return entries.size();
+  }
+
+  size_type getIndexBytes() const //memory used by the perfect hash on top of the entries themselves
+  {
+    return pilots.size() * sizeof(std::uint16_t) + remap.size() * sizeof(std::uint32_t);
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    if(entries.empty())
+      return cend();
+
+    size_type slot = slotOf(key);
+
+    //a key outside the set still maps to some slot, so the stored key decides
+    if(!equal(entries[slot].first, key))
+      return cend();
+
+    return entries.cbegin() + slot;
+  }
+
+  bool contains(const key_type& key) const
+  {
+    return find(key) != cend();
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    const_iterator it = find(key);
+
+    if(it == cend())
+      throw std::out_of_range("Key not found!");
+
+    return it->second;
+  }
+
+  bool operator==(const FrozenHashMap& other) const
+  {
+    if(getSize() != other.getSize())
+      return false;
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      auto found = find(it->first);
+
+      if(found == cend() || found->second != it->second)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const FrozenHashMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  const_iterator cbegin() const
+  {
+    return entries.cbegin();
+  }
+
+  const_iterator cend() const
+  {
+    return entries.cend();
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_FROZENHASHMAP_H */
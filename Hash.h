@@ -0,0 +1,81 @@
+#ifndef AISDI_MAPS_HASH_H
+#define AISDI_MAPS_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <string>
+#include <string_view>
+
+namespace aisdi
+{
+
+inline std::uint64_t mix64(std::uint64_t hash) //murmur3 finalizer, every input bit affects every output bit
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ull;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+template <typename KeyType, typename Enable = void>
+struct DefaultHash : std::hash<KeyType>
+{};
+
+template <typename KeyType>
+struct DefaultHash<KeyType, typename std::enable_if<std::is_integral<KeyType>::value>::type>
+{
+  std::size_t operator()(KeyType key) const //std::hash is the identity for integers
+  {
+    return static_cast<std::size_t>(mix64(static_cast<std::uint64_t>(key)));
+  }
+};
+
+template <>
+struct DefaultHash<std::string>
+{
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view key) const //equal to std::hash<std::string>, so views and literals hash without a copy
+  {
+    return std::hash<std::string_view>()(key);
+  }
+};
+
+template <typename KeyType>
+struct CachesHashCode : std::integral_constant<bool, !std::is_trivially_copyable<KeyType>::value>
+{}; //whether HashMap stores each entry's hash, specialize it to force caching on or off for a key type
+
+inline std::size_t fibonacciIndex(std::size_t hash, unsigned shift) //maps hash onto [0, 2^(64 - shift)) without a division
+{
+  return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 11400714819323198485ull) >> shift);
+}
+
+inline std::size_t rangeIndex(std::uint64_t hash, std::size_t range) //maps hash onto [0, range) for any range, using the high bits
+{
+#if defined(__SIZEOF_INT128__)
+  return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * range) >> 64);
+#else
+  return static_cast<std::size_t>(hash % range);
+#endif
+}
+
+inline unsigned log2Ceil(std::size_t count)
+{
+  unsigned bits = 0;
+
+  while((std::size_t(1) << bits) < count)
+  {
+    bits++;
+  }
+
+  return bits;
+}
+
+}
+
+#endif /* AISDI_MAPS_HASH_H */
@@ -2,18 +2,79 @@
 #define AISDI_MAPS_HASHMAP_H
 
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <stdexcept>
 #include <utility>
 #include <list>
 #include <functional>
+#include <type_traits>
+#include <tuple>
+#include <memory>
+#include <new>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <exception>
+
+#include "Hash.h"
+#include "Bits.h"
 
 namespace aisdi
 {
 
-  const size_t capacity = 65537;
+  const size_t initialBucketCount = 16;
+  const size_t batchBlockSize = 16;   //keys in flight at once during a batched lookup
+  const size_t incrementalRehashStep = 8; //old buckets drained per insert or remove while an incremental rehash runs
+  const float defaultMaxLoadFactor = 1.0f;
 
-template <typename KeyType, typename ValueType>
+template <typename Value, bool Cached>
+struct HashEntry //a HashMap list element, the full hash is kept next to the value so chain walks and rehashes skip the hasher
+{
+  Value value;
+  std::size_t hashCode;
+
+  template <typename... Args>
+  explicit HashEntry(std::size_t keyHash, Args&&... args)
+    : value(std::forward<Args>(args)...), hashCode(keyHash)
+  {}
+};
+
+template <typename Value>
+struct HashEntry<Value, false>
+{
+  Value value;
+
+  template <typename... Args>
+  explicit HashEntry(std::size_t, Args&&... args)
+    : value(std::forward<Args>(args)...)
+  {}
+};
+
+template <typename Alloc, typename = void>
+struct BucketAllocator //what the bucket lists allocate through, the map's allocator itself unless it offers a lighter handle_type
+{
+  using type = Alloc;
+
+  static const type& of(const Alloc& allocator)
+  {
+    return allocator;
+  }
+};
+
+template <typename Alloc>
+struct BucketAllocator<Alloc, std::void_t<typename Alloc::handle_type> >
+{
+  using type = typename Alloc::handle_type;
+
+  static type of(const Alloc& allocator)
+  {
+    return allocator.handle();
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType>,
+          typename Allocator = std::allocator<std::pair<KeyType, ValueType> > >
 class HashMap
 {
 public:
@@ -23,54 +84,588 @@ public:
   using size_type = std::size_t;
   using reference = value_type&;
   using const_reference = const value_type&;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
 
   class ConstIterator;
   class Iterator;
   using iterator = Iterator;
   using const_iterator = ConstIterator;
 
+  struct BucketStats
+  {
+    size_type bucketCount;
+    size_type emptyBuckets;
+    size_type longestChain;
+    double emptyRatio;                    //emptyBuckets / bucketCount, 1 for an unallocated table
+    std::vector<size_type> chainLengths;  //chainLengths[k] is the number of buckets holding exactly k entries
+  };
+
 private:
-  std::list<value_type > hashTable[capacity + 1];
+  static const bool cachesHash = CachesHashCode<key_type>::value;
+  using entry_type = HashEntry<value_type, cachesHash>;
+  using node_allocator = typename BucketAllocator<allocator_type>::type;
+  using entry_allocator = typename std::allocator_traits<node_allocator>::template rebind_alloc<entry_type>;
+  using bucket_type = std::list<entry_type, entry_allocator>;
+  using table_allocator = typename std::allocator_traits<node_allocator>::template rebind_alloc<bucket_type>;
+
+  bucket_type* hashTable;
+  std::uint64_t* occupied;  //bit i is set while bucket i is not empty
+  size_type bucketCount;    //always a power of two
+  unsigned shift;           //64 - log2(bucketCount), used by the multiplicative reduction
   size_type size;
+  float maxLoadFactor;
+  size_type minBucketCount; //set by reserve() and rehash(), the table never shrinks below it
+  bool incrementalRehash;
+  bucket_type* oldTable;    //the table being drained by an incremental rehash, nullptr otherwise
+  std::uint64_t* oldOccupied;
+  size_type oldBucketCount;
+  unsigned oldShift;
+  size_type migrated;       //old buckets below this one are already empty
+  hasher hash;
+  key_equal equal;
+  allocator_type allocator;   //owned once here, the bucket lists get BucketAllocator's view of it
+
+  template <typename H, typename E>
+  using transparentLookup = std::void_t<typename H::is_transparent, typename E::is_transparent>;
+
+  std::size_t hashOf(const entry_type& entry) const
+  {
+    if constexpr(cachesHash)
+      return entry.hashCode;
+    else
+      return hash(entry.value.first);
+  }
+
+  template <typename K>
+  bool matches(const entry_type& entry, const K& key, std::size_t keyHash) const //a differing cached hash rules the key out without comparing it
+  {
+    if constexpr(cachesHash)
+    {
+      if(entry.hashCode != keyHash)
+        return false;
+    }
+
+    return equal(entry.value.first, key);
+  }
+
+  template <typename K>
+  typename bucket_type::iterator findIn(bucket_type& bucket, const K& key, std::size_t keyHash) const //returns the bucket's end() if key is not in it
+  {
+    typename bucket_type::iterator it = bucket.begin();
+
+    while(it != bucket.end() && !matches(*it, key, keyHash))
+    {
+      it++;
+    }
+
+    return it;
+  }
+
+  size_type endIndex() const //iterator positions cover the current table, then the old one while it is being drained
+  {
+    return bucketCount + oldBucketCount;
+  }
+
+  bucket_type& bucketAt(size_type index) const
+  {
+    return index < bucketCount ? hashTable[index] : oldTable[index - bucketCount];
+  }
+
+  size_type indexFor(std::size_t keyHash) const //keys of an old bucket not drained yet, new ones included, stay in the old table
+  {
+    if(oldTable != nullptr)
+    {
+      size_type oldBucket = fibonacciIndex(keyHash, oldShift);
+
+      if(oldBucket >= migrated)
+        return bucketCount + oldBucket;
+    }
+
+    return fibonacciIndex(keyHash, shift);
+  }
+
+  template <typename K>
+  std::pair<size_type, typename bucket_type::iterator> locate(const K& key, std::size_t keyHash) const //index is endIndex() if key is absent, the map must not be empty
+  {
+    size_type index = indexFor(keyHash);
+    bucket_type& bucket = bucketAt(index);
+    typename bucket_type::iterator it = findIn(bucket, key, keyHash);
+
+    if(it != bucket.end())
+      return std::make_pair(index, it);
+
+    return std::make_pair(endIndex(), typename bucket_type::iterator());
+  }
+
+  template <typename K>
+  const_iterator findKey(const K& key) const
+  {
+    if(size == 0)
+      return cend();
+
+    auto found = locate(key, hash(key));
+
+    return ConstIterator(const_cast<HashMap *>(this), found.first, found.second);
+  }
+
+  template <typename K>
+  void removeKey(const K& key)
+  {
+    if(size == 0)
+      throw std::out_of_range("Attempt to remove by wrong key!");
+
+    auto found = locate(key, hash(key));
+
+    if(found.first == endIndex())
+      throw std::out_of_range("Attempt to remove by wrong key!");
+
+    eraseFrom(found.first, found.second);
+    advanceRehash();
+  }
+
+  bool isOccupied(size_type bucket) const
+  {
+    return (occupied[bucket / 64] >> (bucket % 64)) & 1u;
+  }
+
+  template <typename KeyIt, typename F>
+  size_type resolveBatch(KeyIt key, size_type count, F found) const //calls found(it) for each key in order, it is cend() when missing
+  {
+    std::size_t hashes[batchBlockSize];
+    size_type buckets[batchBlockSize];
+    size_type hits = 0;
+
+    for(size_type done = 0; done < count; done += batchBlockSize)
+    {
+      size_type block = count - done < batchBlockSize ? count - done : batchBlockSize;
+      KeyIt blockStart = key;
+
+      //hash the whole block and touch every bucket head before any of them is needed
+      for(size_type i = 0; i < block; i++, ++key)
+      {
+        hashes[i] = hash(*key);
+        buckets[i] = fibonacciIndex(hashes[i], shift);
+        prefetchRead(hashTable + buckets[i]);
+      }
+
+      //the heads are arriving, start fetching the first node of each non-empty chain
+      for(size_type i = 0; i < block; i++)
+      {
+        if(isOccupied(buckets[i]))
+          prefetchRead(&hashTable[buckets[i]].front());
+      }
+
+      key = blockStart;
+      for(size_type i = 0; i < block; i++, ++key)
+      {
+        std::pair<size_type, typename bucket_type::iterator> position(buckets[i], typename bucket_type::iterator());
+
+        if(isOccupied(buckets[i]))
+          position.second = findIn(hashTable[buckets[i]], *key, hashes[i]);
+
+        if(!isOccupied(buckets[i]) || position.second == hashTable[buckets[i]].end())
+          position = oldTable != nullptr ? locate(*key, hashes[i]) : std::make_pair(endIndex(), typename bucket_type::iterator());
+
+        if(position.first != endIndex())
+          hits++;
+
+        found(ConstIterator(const_cast<HashMap *>(this), position.first, position.second));
+      }
+    }
+
+    return hits;
+  }
+
+  static size_type wordsFor(size_type buckets)
+  {
+    return (buckets + 63) / 64;
+  }
+
+  size_type occupiedWords() const
+  {
+    return wordsFor(bucketCount);
+  }
+
+  void markOccupied(size_type index)
+  {
+    if(index < bucketCount)
+      occupied[index / 64] |= std::uint64_t(1) << (index % 64);
+    else
+      oldOccupied[(index - bucketCount) / 64] |= std::uint64_t(1) << ((index - bucketCount) % 64);
+  }
+
+  void eraseFrom(size_type index, typename bucket_type::const_iterator it)
+  {
+    bucket_type& bucket = bucketAt(index);
+
+    bucket.erase(it);
+    size--;
+
+    if(!bucket.empty())
+      return;
+
+    if(index < bucketCount)
+      occupied[index / 64] &= ~(std::uint64_t(1) << (index % 64));
+    else
+      oldOccupied[(index - bucketCount) / 64] &= ~(std::uint64_t(1) << ((index - bucketCount) % 64));
+  }
+
+  static size_type scanForward(const std::uint64_t* bitmap, size_type count, size_type bucket) //first set bit at or after bucket, count if there is none
+  {
+    size_type word = bucket / 64;
+
+    if(word >= wordsFor(count))
+      return count;
+
+    std::uint64_t bits = bitmap[word] & (~std::uint64_t(0) << (bucket % 64));
+
+    while(bits == 0)
+    {
+      if(++word == wordsFor(count))
+        return count;
+
+      bits = bitmap[word];
+    }
 
-  void insert(value_type val)
+    return word * 64 + countTrailingZeros(bits);
+  }
+
+  static size_type scanBackward(const std::uint64_t* bitmap, size_type count, size_type bucket) //last set bit before bucket, count if there is none
+  {
+    if(bucket == 0)
+      return count;
+
+    size_type word = (bucket - 1) / 64;
+    std::uint64_t bits = bitmap[word] & (~std::uint64_t(0) >> (63 - (bucket - 1) % 64));
+
+    while(bits == 0)
+    {
+      if(word == 0)
+        return count;
+
+      bits = bitmap[--word];
+    }
+
+    return word * 64 + 63 - countLeadingZeros(bits);
+  }
+
+  size_type nextOccupied(size_type index) const //first non-empty bucket at or after index, endIndex() if there is none
+  {
+    if(index < bucketCount)
+    {
+      size_type found = scanForward(occupied, bucketCount, index);
+
+      if(found != bucketCount)
+        return found;
+
+      index = bucketCount;
+    }
+
+    if(oldTable != nullptr)
+    {
+      size_type found = scanForward(oldOccupied, oldBucketCount, index - bucketCount);
+
+      if(found != oldBucketCount)
+        return bucketCount + found;
+    }
+
+    return endIndex();
+  }
+
+  size_type previousOccupied(size_type index) const //last non-empty bucket before index, endIndex() if there is none
+  {
+    if(index > bucketCount)
+    {
+      size_type found = scanBackward(oldOccupied, oldBucketCount, index - bucketCount);
+
+      if(found != oldBucketCount)
+        return bucketCount + found;
+
+      index = bucketCount;
+    }
+
+    size_type found = scanBackward(occupied, bucketCount, index);
+
+    return found == bucketCount ? endIndex() : found;
+  }
+
+  size_type bucketCountFor(size_type elements) const //smallest table keeping elements under the max load factor
+  {
+    size_type count = initialBucketCount;
+
+    while(count < minBucketCount || elements > count * maxLoadFactor)
+    {
+      count *= 2;
+    }
+
+    return count;
+  }
+
+  size_type builtBuckets() const //buckets of the current table constructed so far, a rehash builds them as it drains into them
+  {
+    return oldTable == nullptr ? bucketCount : migrated * (bucketCount / oldBucketCount);
+  }
+
+  void buildBuckets(size_type from, size_type to)
+  {
+    entry_allocator entries(BucketAllocator<allocator_type>::of(allocator));
+
+    for(size_type i = from; i < to; i++)
+    {
+      new (hashTable + i) bucket_type(entries);
+    }
+  }
+
+  void allocateUnbuilt(size_type newBucketCount) //no bucket is constructed yet
+  {
+    hashTable = table_allocator(BucketAllocator<allocator_type>::of(allocator)).allocate(newBucketCount);
+    bucketCount = newBucketCount;
+    shift = 64 - log2Ceil(newBucketCount);
+    occupied = new std::uint64_t[occupiedWords()]();
+  }
+
+  void allocate(size_type newBucketCount)
+  {
+    allocateUnbuilt(newBucketCount);
+    buildBuckets(0, newBucketCount);
+  }
+
+  void releaseTable(bucket_type* table, size_type count, size_type first, size_type last) //buckets outside first..last are not constructed
+  {
+    if(table == nullptr)
+      return;
+
+    for(size_type i = first; i < last; i++)
+    {
+      table[i].~bucket_type();
+    }
+
+    table_allocator(BucketAllocator<allocator_type>::of(allocator)).deallocate(table, count);
+  }
+
+  void release()
   {
-    size_type destination = std::hash<key_type >()(val.first) % capacity;
+    releaseTable(hashTable, bucketCount, 0, builtBuckets());
+    delete[] occupied;
+    releaseTable(oldTable, oldBucketCount, migrated, oldBucketCount);
+    delete[] oldOccupied;
+  }
+
+  void moveBucket(bucket_type& bucket) //splices every node of bucket into the current table, cached hashes are reused
+  {
+    while(!bucket.empty())
+    {
+      size_type destination = fibonacciIndex(hashOf(bucket.front()), shift);
+      hashTable[destination].splice(hashTable[destination].end(), bucket, bucket.begin());
+      occupied[destination / 64] |= std::uint64_t(1) << (destination % 64);
+    }
+  }
+
+  void dropOldTable() //every old bucket is drained and destroyed already
+  {
+    releaseTable(oldTable, oldBucketCount, 0, 0);
+    delete[] oldOccupied;
+    oldTable = nullptr;
+    oldOccupied = nullptr;
+    oldBucketCount = 0;
+    oldShift = 64;
+    migrated = 0;
+  }
+
+  void advanceRehash() //drains up to incrementalRehashStep buckets of the old table, a no-op unless a rehash is in progress
+  {
+    if(oldTable == nullptr)
+      return;
+
+    size_type stop = migrated + incrementalRehashStep < oldBucketCount ? migrated + incrementalRehashStep : oldBucketCount;
+    size_type ratio = bucketCount / oldBucketCount;
+
+    for(; migrated < stop; migrated++)
+    {
+      //an old bucket only spreads over the ratio new buckets sharing its top hash bits, build those and move it in
+      buildBuckets(migrated * ratio, (migrated + 1) * ratio);
+      moveBucket(oldTable[migrated]);
+      oldTable[migrated].~bucket_type();  //destroyed as it is drained, so dropping the old table is not one more full pass
+      oldOccupied[migrated / 64] &= ~(std::uint64_t(1) << (migrated % 64));
+    }
+
+    if(migrated == oldBucketCount)
+      dropOldTable();
+  }
+
+  void finishRehash()
+  {
+    while(oldTable != nullptr)
+    {
+      advanceRehash();
+    }
+  }
+
+  void moveTo(size_type newBucketCount) //moves every node to a freshly allocated table at once, no copies are made
+  {
+    finishRehash();
+
+    bucket_type* previousTable = hashTable;
+    std::uint64_t* previousOccupied = occupied;
+    size_type previousBucketCount = bucketCount;
+    size_type previousWords = occupiedWords();
+
+    allocate(newBucketCount);
+
+    for(size_type word = 0; word < previousWords; word++)
+    {
+      for(std::uint64_t bits = previousOccupied[word]; bits != 0; bits &= bits - 1)
+      {
+        moveBucket(previousTable[word * 64 + countTrailingZeros(bits)]);
+      }
+    }
 
-    hashTable[destination].push_back(val);
+    releaseTable(previousTable, previousBucketCount, 0, previousBucketCount);
+    delete[] previousOccupied;
+  }
+
+  void startRehash(size_type newBucketCount) //the current table becomes the old one and is drained by later inserts and removes
+  {
+    finishRehash();
+
+    oldTable = hashTable;
+    oldOccupied = occupied;
+    oldBucketCount = bucketCount;
+    oldShift = shift;
+    migrated = 0;
+
+    allocateUnbuilt(newBucketCount);  //building every bucket here would make this one insert cost the whole table
+  }
+
+  void fitTo(size_type elements) //grows the table past the max load factor, shrinks it once it is mostly empty
+  {
+    size_type wanted = bucketCountFor(elements);
+
+    if(incrementalRehash && bucketCount != 0)
+    {
+      if(wanted > bucketCount) //never shrinks, a shrink would be one more full pass
+        startRehash(wanted);
+    }
+    else if(wanted > bucketCount || wanted * 4 < bucketCount)
+    {
+      moveTo(wanted);
+    }
+  }
+
+  template <typename... Args>
+  iterator placeNew(std::size_t keyHash, Args&&... args) //key must be absent, keyHash is reused so it is not hashed again
+  {
+    fitTo(size + 1);
+    advanceRehash();
+
+    size_type destination = indexFor(keyHash);
+    bucket_type& bucket = bucketAt(destination);
+
+    bucket.emplace_back(keyHash, std::forward<Args>(args)...);
+    markOccupied(destination);
     size++;
+
+    return Iterator(this, destination, --bucket.end());
   }
 
-  void removeAll()
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> tryEmplace(K&& key, Args&&... args) //args are only consumed if key is inserted
   {
-    for(size_type i = 0; i < capacity; i++)
+    std::size_t keyHash = hash(key);
+
+    if(size != 0)
     {
-      hashTable[i].clear();
+      auto found = locate(key, keyHash);
+
+      if(found.first != endIndex())
+        return std::make_pair(Iterator(this, found.first, found.second), false);
     }
+
+    iterator inserted = placeNew(keyHash, std::piecewise_construct,
+                                 std::forward_as_tuple(std::forward<K>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+
+    return std::make_pair(inserted, true);
+  }
+
+  void insert(const value_type& val) //key must be absent
+  {
+    placeNew(hash(val.first), val);
+  }
+
+  void makeEmpty() //the unallocated state, the table is created by the first insert
+  {
+    hashTable = nullptr;
+    occupied = nullptr;
+    bucketCount = 0;
+    shift = 64;
     size = 0;
+    oldTable = nullptr;
+    oldOccupied = nullptr;
+    oldBucketCount = 0;
+    oldShift = 64;
+    migrated = 0;
+  }
+
+  static void clearBuckets(bucket_type* table, std::uint64_t* bits, size_type count) //empties only the buckets marked in bits
+  {
+    for(size_type word = 0; word < wordsFor(count); word++)
+    {
+      if(bits[word] == 0)
+        continue;
+
+      for(std::uint64_t set = bits[word]; set != 0; set &= set - 1)
+      {
+        table[word * 64 + countTrailingZeros(set)].clear();
+      }
+
+      bits[word] = 0;
+    }
   }
 
 public:
-  HashMap() : size(0)
+  HashMap() : maxLoadFactor(defaultMaxLoadFactor), minBucketCount(0), incrementalRehash(false)
   {
-    hashTable[capacity].push_back(value_type(key_type(), mapped_type()));
+    makeEmpty();
+  }
+
+  explicit HashMap(const hasher& hashFunction, const key_equal& keyEqual = key_equal(), const allocator_type& alloc = allocator_type())
+    : maxLoadFactor(defaultMaxLoadFactor), minBucketCount(0), incrementalRehash(false), hash(hashFunction), equal(keyEqual), allocator(alloc)
+  {
+    makeEmpty();
+  }
+
+  explicit HashMap(const allocator_type& alloc)
+    : maxLoadFactor(defaultMaxLoadFactor), minBucketCount(0), incrementalRehash(false), allocator(alloc)
+  {
+    makeEmpty();
   }
 
   HashMap(std::initializer_list<value_type> list)
   {
-    size = 0;
-    hashTable[capacity].push_back(value_type(key_type(), mapped_type()));
+    makeEmpty();
+    maxLoadFactor = defaultMaxLoadFactor;
+    minBucketCount = 0;
+    incrementalRehash = false;
+    allocate(bucketCountFor(list.size()));
 
     for(auto it = list.begin(); it != list.end(); ++it)
     {
-      insert(*it);
+      tryEmplace(it->first, it->second);
     }
   }
 
   HashMap(const HashMap& other)
+    : hash(other.hash), equal(other.equal),
+      allocator(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.allocator))
   {
-    size = 0;
-    hashTable[capacity].push_back(value_type(key_type(), mapped_type()));
+    makeEmpty();
+    maxLoadFactor = other.maxLoadFactor;
+    minBucketCount = other.minBucketCount;
+    incrementalRehash = other.incrementalRehash;
+    allocate(bucketCountFor(other.size));
 
     for(auto it = other.cbegin(); it != other.cend(); ++it)
     {
@@ -79,15 +674,17 @@ public:
   }
 
   HashMap(HashMap&& other) noexcept
+    : hashTable(other.hashTable), occupied(other.occupied), bucketCount(other.bucketCount), shift(other.shift),
+      size(other.size), maxLoadFactor(other.maxLoadFactor), minBucketCount(other.minBucketCount), incrementalRehash(other.incrementalRehash),
+      oldTable(other.oldTable), oldOccupied(other.oldOccupied), oldBucketCount(other.oldBucketCount), oldShift(other.oldShift),
+      migrated(other.migrated), hash(std::move(other.hash)), equal(std::move(other.equal)), allocator(other.allocator)
   {
-    size = other.size;
-    other.size = 0;
+    other.makeEmpty();
+  }
 
-    for(size_type i = 0; i <= capacity; i++)
-    {
-      hashTable[i] = std::move(other.hashTable[i]);
-      other.hashTable[i].clear();
-    }
+  ~HashMap()
+  {
+    release();
   }
 
   HashMap& operator=(const HashMap& other)
@@ -95,7 +692,12 @@ public:
     if(*this == other)
       return *this;
 
-    removeAll();
+    clear();
+    maxLoadFactor = other.maxLoadFactor;
+    minBucketCount = other.minBucketCount;
+    incrementalRehash = other.incrementalRehash;
+    hash = other.hash;
+    equal = other.equal;
 
     for(auto it = other.cbegin(); it != other.cend(); ++it)
     {
@@ -107,21 +709,151 @@ public:
 
   HashMap& operator=(HashMap&& other) noexcept
   {
-    if(*this == other)
+    if(this == &other)
       return *this;
 
-    removeAll();
+    HashMap taken(std::move(other));
+    swap(taken);
 
-    size = other.size;
-    other.size = 0;
+    return *this;
+  }
 
-    for(size_type i = 0; i < capacity; i++)
+  void swap(HashMap& other) noexcept
+  {
+    std::swap(hashTable, other.hashTable);
+    std::swap(occupied, other.occupied);
+    std::swap(bucketCount, other.bucketCount);
+    std::swap(shift, other.shift);
+    std::swap(size, other.size);
+    std::swap(maxLoadFactor, other.maxLoadFactor);
+    std::swap(minBucketCount, other.minBucketCount);
+    std::swap(incrementalRehash, other.incrementalRehash);
+    std::swap(oldTable, other.oldTable);
+    std::swap(oldOccupied, other.oldOccupied);
+    std::swap(oldBucketCount, other.oldBucketCount);
+    std::swap(oldShift, other.oldShift);
+    std::swap(migrated, other.migrated);
+    std::swap(hash, other.hash);
+    std::swap(equal, other.equal);
+    std::swap(allocator, other.allocator);
+  }
+
+  hasher hash_function() const
+  {
+    return hash;
+  }
+
+  key_equal key_eq() const
+  {
+    return equal;
+  }
+
+  allocator_type get_allocator() const
+  {
+    return allocator;
+  }
+
+  float max_load_factor() const
+  {
+    return maxLoadFactor;
+  }
+
+  void max_load_factor(float factor) //the table is resized right away if it no longer fits the new factor
+  {
+    if(!(factor > 0.0f))
+      throw std::invalid_argument("Max load factor must be positive!");
+
+    maxLoadFactor = factor;
+
+    if(bucketCount != 0)
+      fitTo(size);
+  }
+
+  float load_factor() const
+  {
+    return bucketCount == 0 ? 0.0f : static_cast<float>(size) / bucketCount;
+  }
+
+  size_type bucket_count() const
+  {
+    return bucketCount;
+  }
+
+  void rehash(size_type buckets) //at least buckets buckets, rounded up to a power of two, from now on; rehash(0) lifts the floor
+  {
+    minBucketCount = buckets == 0 ? 0 : size_type(1) << log2Ceil(buckets);
+
+    if(bucketCount == 0)
+    {
+      if(minBucketCount != 0)
+        allocate(bucketCountFor(0));
+    }
+    else if(bucketCountFor(size) != bucketCount)
     {
-      hashTable[i] = std::move(other.hashTable[i]);
-      other.hashTable[i].clear();
+      moveTo(bucketCountFor(size));
     }
+  }
 
-    return *this;
+  void reserve(size_type elements) //room for elements entries without any further rehash
+  {
+    size_type buckets = 1;
+
+    while(elements > buckets * maxLoadFactor)
+    {
+      buckets *= 2;
+    }
+
+    rehash(elements == 0 ? 0 : buckets);
+  }
+
+  //growth then drains the old table a few buckets per insert or remove; draining moves entries, so those calls invalidate
+  //every iterator while isRehashing(), lookups (find, valueOf, operator[] on a present key) never move anything
+  void setIncrementalRehash(bool enabled)
+  {
+    incrementalRehash = enabled;
+
+    if(!enabled)
+      finishRehash();
+  }
+
+  bool isIncrementalRehash() const
+  {
+    return incrementalRehash;
+  }
+
+  bool isRehashing() const
+  {
+    return oldTable != nullptr;
+  }
+
+  BucketStats bucketStats() const //counts the old table's buckets too while a rehash is in progress
+  {
+    BucketStats stats;
+
+    stats.bucketCount = endIndex();
+    stats.emptyBuckets = 0;
+    stats.longestChain = 0;
+
+    size_type built = builtBuckets();
+
+    for(size_type i = 0; i < endIndex(); i++)
+    {
+      bool constructed = i < bucketCount ? i < built : i - bucketCount >= migrated;
+      size_type length = constructed ? bucketAt(i).size() : 0;
+
+      if(length >= stats.chainLengths.size())
+        stats.chainLengths.resize(length + 1, 0);
+
+      stats.chainLengths[length]++;
+
+      if(length > stats.longestChain)
+        stats.longestChain = length;
+      if(length == 0)
+        stats.emptyBuckets++;
+    }
+
+    stats.emptyRatio = stats.bucketCount == 0 ? 1.0 : static_cast<double>(stats.emptyBuckets) / stats.bucketCount;
+    return stats;
   }
 
   bool isEmpty() const
@@ -129,17 +861,94 @@ public:
     return size == 0;
   }
 
-  mapped_type& operator[](const key_type& key)
+  void clear() //keeps the table, so the cost is the entry count plus one bitmap word per 64 buckets
   {
-    iterator it = find(key);
+    if(size == 0)
+      return;
 
-    if(it == end())
+    clearBuckets(hashTable, occupied, bucketCount);
+
+    if(oldTable != nullptr) //the drain goes on over empty buckets, finishing it here would build the rest of the table
+      clearBuckets(oldTable, oldOccupied, oldBucketCount);
+
+    size = 0;
+  }
+
+  mapped_type& operator[](const key_type& key) //only an insert may advance an incremental rehash
+  {
+    return (*tryEmplace(key).first).second;
+  }
+
+  mapped_type& operator[](key_type&& key)
+  {
+    return (*tryEmplace(std::move(key)).first).second;
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) //builds the entry first, it is dropped if its key is already present
+  {
+    bucket_type entry((entry_allocator(BucketAllocator<allocator_type>::of(allocator))));
+    entry.emplace_back(0, std::forward<Args>(args)...);
+
+    const key_type& key = entry.front().value.first;
+    std::size_t keyHash = hash(key);
+
+    if constexpr(cachesHash)
+      entry.front().hashCode = keyHash;
+
+    if(size != 0)
     {
-      insert(value_type(key, mapped_type()));
-      it = find(key);
+      auto found = locate(key, keyHash);
+
+      if(found.first != endIndex())
+        return std::make_pair(Iterator(this, found.first, found.second), false);
     }
 
-      return (*it).second;
+    fitTo(size + 1);
+    advanceRehash();
+
+    size_type destination = indexFor(keyHash);
+    bucket_type& bucket = bucketAt(destination);
+
+    bucket.splice(bucket.end(), entry);
+    markOccupied(destination);
+    size++;
+
+    return std::make_pair(Iterator(this, destination, --bucket.end()), true);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+  {
+    return tryEmplace(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+  {
+    return tryEmplace(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+  {
+    std::pair<iterator, bool> result = tryEmplace(key, std::forward<M>(obj));
+
+    if(!result.second)
+      (*result.first).second = std::forward<M>(obj);
+
+    return result;
+  }
+
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+  {
+    std::pair<iterator, bool> result = tryEmplace(std::move(key), std::forward<M>(obj));
+
+    if(!result.second)
+      (*result.first).second = std::forward<M>(obj);
+
+    return result;
   }
 
   const mapped_type& valueOf(const key_type& key) const
@@ -152,7 +961,7 @@ public:
       return (*it).second;
   }
 
-  mapped_type& valueOf(const key_type& key)
+  mapped_type& valueOf(const key_type& key) //read-only like the const overload, no rehash step is taken
   {
     iterator it = find(key);
 
@@ -162,67 +971,91 @@ public:
       return (*it).second;
   }
 
-  const_iterator find(const key_type& key) const
+  template <typename K, typename H = hasher, typename E = key_equal, typename = transparentLookup<H, E> >
+  const mapped_type& valueOf(const K& key) const
   {
-    size_type hashKey = std::hash<key_type >()(key) % capacity;
-    typename std::list<value_type >::const_iterator it = hashTable[hashKey].begin();
+    const_iterator it = findKey(key);
 
-    while((*it).first != key && it != hashTable[hashKey].end())
-    {
-      it++;
-    }
+    if(it == cend())
+      throw std::out_of_range("Key not found!");
+    else
+      return (*it).second;
+  }
 
-    if((*it).first != key || it == hashTable[hashKey].end())
-    {
-      return cend();
-    }
+  template <typename K, typename H = hasher, typename E = key_equal, typename = transparentLookup<H, E> >
+  mapped_type& valueOf(const K& key)
+  {
+    iterator it = findKey(key);
+
+    if(it == end())
+      throw std::out_of_range("Key not found!");
     else
-    {
-      const_iterator result = ConstIterator(const_cast<HashMap *>(this), hashKey, it);
-      return result;
-    }
+      return (*it).second;
   }
 
-  iterator find(const key_type& key)
+  const_iterator find(const key_type& key) const
   {
-    size_type hashKey = std::hash<key_type >()(key) % capacity;
-    typename std::list<value_type >::iterator it = hashTable[hashKey].begin();
+    return findKey(key);
+  }
 
-    while((*it).first != key && it != hashTable[hashKey].end())
-    {
-      it++;
-    }
+  iterator find(const key_type& key) //never moves entries, so other iterators stay valid
+  {
+    return findKey(key);
+  }
 
-    if((*it).first != key || it == hashTable[hashKey].end())
-    {
-      return end();
-    }
-    else
-    {
-      iterator result = Iterator(this, hashKey, it);
-      return result;
-    }
+  template <typename K, typename H = hasher, typename E = key_equal, typename = transparentLookup<H, E> >
+  const_iterator find(const K& key) const //lookup by any type both functors accept, no key_type is built
+  {
+    return findKey(key);
   }
 
-  void remove(const key_type& key)
+  template <typename K, typename H = hasher, typename E = key_equal, typename = transparentLookup<H, E> >
+  iterator find(const K& key)
   {
-    size_type hashKey = std::hash<key_type >()(key) % capacity;
-    typename std::list<value_type >::iterator it = hashTable[hashKey].begin();
+    return findKey(key);
+  }
 
-    while((*it).first != key && it != hashTable[hashKey].end())
+  template <typename KeyRange, typename OutputIt>
+  size_type findBatch(const KeyRange& keys, OutputIt out) const //writes a const_iterator per key, cend() for missing ones, returns the hit count
+  {
+    if(size == 0)
     {
-      it++;
-    }
+      for(auto it = keys.begin(); it != keys.end(); ++it)
+      {
+        *out++ = cend();
+      }
 
-    if((*it).first == key)
-    {
-      hashTable[hashKey].erase(it);
-      size--;
+      return 0;
     }
-    else
+
+    return resolveBatch(keys.begin(), keys.size(), [&out](const const_iterator& it) { *out++ = it; });
+  }
+
+  template <typename KeyRange, typename OutputIt>
+  size_type containsBatch(const KeyRange& keys, OutputIt out) const //writes a bool per key, returns the hit count
+  {
+    if(size == 0)
     {
-      throw std::out_of_range("Attempt to remove by wrong key!");
+      for(auto it = keys.begin(); it != keys.end(); ++it)
+      {
+        *out++ = false;
+      }
+
+      return 0;
     }
+
+    return resolveBatch(keys.begin(), keys.size(), [this, &out](const const_iterator& it) { *out++ = it != cend(); });
+  }
+
+  void remove(const key_type& key)
+  {
+    removeKey(key);
+  }
+
+  template <typename K, typename H = hasher, typename E = key_equal, typename = transparentLookup<H, E> >
+  void remove(const K& key)
+  {
+    removeKey(key);
   }
 
   void remove(const const_iterator& it)
@@ -230,11 +1063,7 @@ public:
     if(it == cend())
       throw std::out_of_range("Attempt to remove end iterator!");
 
-    if(it.it != hashTable[it.index].cend())
-    {
-      hashTable[it.index].erase(it.it);
-      size--;
-    }
+    eraseFrom(it.index, it.it);
   }
 
   size_type getSize() const
@@ -262,62 +1091,111 @@ public:
     return !(*this == other);
   }
 
-  iterator begin()
+  std::vector<std::pair<const_iterator, const_iterator> > partition(size_type parts) const //at most parts ranges of about size / parts entries, cut at bucket boundaries
   {
-    typename std::list<value_type >::iterator bIt;
-    size_type i = 0;
-    iterator it;
+    if(parts == 0)
+      throw std::invalid_argument("Partition count must be positive!");
+
+    std::vector<std::pair<const_iterator, const_iterator> > ranges;
+
+    if(size == 0)
+      return ranges;
 
-    while(hashTable[i].empty() && i < capacity)
+    size_type seen = 0;
+    size_type first = nextOccupied(0);
+
+    for(size_type i = first; i != endIndex(); i = nextOccupied(i + 1))
     {
-      i++;
-    }
+      seen += bucketAt(i).size();
 
-    bIt = hashTable[i].begin();
+      if(seen * parts >= (ranges.size() + 1) * size) //this range holds its share, the next one starts at the following bucket
+      {
+        size_type next = nextOccupied(i + 1);
 
-    it = Iterator(this, i, bIt);
+        ranges.emplace_back(ConstIterator(const_cast<HashMap *>(this), first, bucketAt(first).cbegin()),
+                            next == endIndex() ? cend() : ConstIterator(const_cast<HashMap *>(this), next, bucketAt(next).cbegin()));
+        first = next;
+      }
+    }
 
-    return it;
+    return ranges;
   }
 
-  iterator end()
+  template <typename F>
+  void parallelForEach(F fn, size_type threads = 0) const //fn(const value_type&) is called concurrently, the map must not change meanwhile
   {
-    typename std::list<value_type >::iterator bIt;
-    iterator it;
+    if(threads == 0)
+      threads = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
 
-    bIt = hashTable[capacity].begin();
-    it = Iterator(this, capacity, bIt);
+    std::vector<std::pair<const_iterator, const_iterator> > ranges = partition(threads);
+    std::vector<std::thread> workers;
+    std::exception_ptr failure;
+    std::mutex failureLock;
 
-    return it;
-  }
+    auto visit = [&fn, &failure, &failureLock](const std::pair<const_iterator, const_iterator>& range)
+    {
+      try
+      {
+        for(const_iterator it = range.first; it != range.second; ++it)
+        {
+          fn(*it);
+        }
+      }
+      catch(...)
+      {
+        std::lock_guard<std::mutex> guard(failureLock);
 
-  const_iterator cbegin() const
-  {
-    typename std::list<value_type >::const_iterator bIt;
-    size_type i = 0;
-    const_iterator it;
+        if(!failure)
+          failure = std::current_exception();
+      }
+    };
 
-    while(hashTable[i].empty() && i < capacity)
+    //the calling thread takes the first range itself
+    for(size_type i = 1; i < ranges.size(); i++)
     {
-      i++;
+      workers.emplace_back(visit, std::cref(ranges[i]));
     }
 
-    bIt = hashTable[i].begin();
+    if(!ranges.empty())
+      visit(ranges[0]);
 
-    it = ConstIterator(const_cast<HashMap *>(this), i, bIt);
+    for(auto& worker : workers)
+    {
+      worker.join();
+    }
 
-    return it;
+    if(failure)
+      std::rethrow_exception(failure);
   }
 
-  const_iterator cend() const
+  iterator begin()
   {
-    typename std::list<value_type >::const_iterator eIt;
-    const_iterator it;
+    size_type i = nextOccupied(0);
 
-    eIt = hashTable[capacity].begin();
-    it = ConstIterator(const_cast<HashMap *>(this), capacity, eIt);
+    if(i == endIndex())
+      return end();
 
-    return it;
+    return Iterator(this, i, bucketAt(i).begin());
+  }
+
+  iterator end()
+  {
+    return Iterator(this, endIndex(), typename bucket_type::iterator());
+  }
+
+  const_iterator cbegin() const
+  {
+    size_type i = nextOccupied(0);
+
+    if(i == endIndex())
+      return cend();
+
+    return ConstIterator(const_cast<HashMap *>(this), i, bucketAt(i).cbegin());
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(const_cast<HashMap *>(this), endIndex(), typename bucket_type::const_iterator());
   }
 
   const_iterator begin() const
@@ -331,8 +1209,14 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class HashMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual, typename Allocator>
+void swap(HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>& first, HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>& second) noexcept
+{
+  first.swap(second);
+}
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual, typename Allocator>
+class HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>::ConstIterator
 {
 public:
   using reference = typename HashMap::const_reference;
@@ -341,14 +1225,14 @@ public:
   using pointer = const typename HashMap::value_type*;
 
 protected:
-  friend class HashMap<key_type ,mapped_type >;
+  friend class HashMap;
 
-  HashMap<key_type , mapped_type >* collection;
+  HashMap* collection;
   size_type index;
-  typename std::list<value_type >::const_iterator it;
+  typename bucket_type::const_iterator it;
 
 public:
-  explicit ConstIterator(HashMap<key_type , mapped_type >* coll, size_type newIndex, typename std::list<value_type>::const_iterator iter)
+  explicit ConstIterator(HashMap* coll, size_type newIndex, typename bucket_type::const_iterator iter)
   {
     collection = coll;
     index = newIndex;
@@ -375,26 +1259,16 @@ public:
     if(*this == collection->cend())
       throw std::out_of_range("Attempt to reach past end iterator!");
 
-    typename std::list<value_type >::const_iterator last = --(collection->hashTable[index].cend());
-
-    if(it != last)
-    {
-      it++;
+    if(++it != collection->bucketAt(index).cend())
       return *this;
-    }
 
-    for(size_type i = ++index; i < capacity; i++)
-    {
-      if(!(collection->hashTable[i].empty()))
-      {
-        index = i;
-        it = collection->hashTable[i].cbegin();
-        return *this;
-      }
-    }
+    index = collection->nextOccupied(index + 1);
+
+    if(index == collection->endIndex())
+      it = typename bucket_type::const_iterator();
+    else
+      it = collection->bucketAt(index).cbegin();
 
-    index = capacity;
-    it = collection->hashTable[capacity].cbegin();
     return *this;
   }
 
@@ -408,26 +1282,16 @@ public:
   ConstIterator& operator--()
   {
     if(*this == collection->cbegin())
-      throw std::out_of_range("");
+      throw std::out_of_range("Attempt to reach before first element!");
 
-    if(it != collection->hashTable[index].cbegin())
+    if(index < collection->endIndex() && it != collection->bucketAt(index).cbegin())
     {
       it--;
       return *this;
     }
 
-    for(int i = --index; i > 0; i--)
-    {
-      if(!(collection->hashTable[i].empty()))
-      {
-        index = i;
-        it = --(collection->hashTable[i].cend());
-        return *this;
-      }
-    }
-
-    index = 0;
-    it = --(collection->hashTable[0].cend());
+    index = collection->previousOccupied(index);
+    it = --(collection->bucketAt(index).cend());
     return *this;
   }
 
@@ -443,7 +1307,7 @@ public:
     if(*this == collection->end())
       throw std::out_of_range("Attempt to dereference end iterator!");
 
-    return *it;
+    return it->value;
   }
 
   pointer operator->() const
@@ -462,14 +1326,14 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class HashMap<KeyType, ValueType>::Iterator : public HashMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual, typename Allocator>
+class HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>::Iterator : public HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>::ConstIterator
 {
 public:
   using reference = typename HashMap::reference;
   using pointer = typename HashMap::value_type*;
 
-  explicit Iterator(HashMap<key_type , mapped_type >* coll, size_type newIndex, typename std::list<value_type>::iterator iter)
+  explicit Iterator(HashMap* coll, size_type newIndex, typename bucket_type::iterator iter)
           : ConstIterator(coll, newIndex, iter)
   {}
 
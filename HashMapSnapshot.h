@@ -0,0 +1,302 @@
+#ifndef AISDI_MAPS_HASHMAPSNAPSHOT_H
+#define AISDI_MAPS_HASHMAPSNAPSHOT_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Hash.h"
+#include "HashMap.h"
+
+namespace aisdi
+{
+
+  const char snapshotMagic[8] = {'A', 'I', 'S', 'D', 'I', 'M', 'A', 'P'};
+  const std::uint32_t snapshotVersion = 1;
+
+struct SnapshotHeader //image layout: header, bucketCount + 1 entry offsets, entries grouped by bucket
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t shift;
+  std::uint64_t keySize;      //size and alignment of both types catch an image opened with the wrong map type
+  std::uint64_t keyAlign;
+  std::uint64_t valueSize;
+  std::uint64_t valueAlign;
+  std::uint64_t bucketCount;
+  std::uint64_t entryCount;
+  std::uint64_t entriesOffset;
+};
+
+template <typename KeyType, typename ValueType>
+struct SnapshotEntry
+{
+  KeyType key;
+  ValueType value;
+};
+
+inline std::uint64_t snapshotEntriesOffset(std::uint64_t bucketCount, std::uint64_t entryAlign)
+{
+  std::uint64_t end = sizeof(SnapshotHeader) + (bucketCount + 1) * sizeof(std::uint64_t);
+  return (end + entryAlign - 1) / entryAlign * entryAlign;
+}
+
+inline bool writeSnapshotPart(int fd, const void* data, std::size_t size) //false on any error, write may take several calls
+{
+  const char* cursor = static_cast<const char*>(data);
+
+  while(size > 0)
+  {
+    ssize_t done = ::write(fd, cursor, size);
+
+    if(done < 0 && errno == EINTR)
+      continue;
+    if(done <= 0)
+      return false;
+
+    cursor += done;
+    size -= static_cast<std::size_t>(done);
+  }
+
+  return true;
+}
+
+//the image is only valid for a hasher giving the same results in the reading process, DefaultHash does for integers
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual, typename Allocator>
+void saveSnapshot(const HashMap<KeyType, ValueType, Hash, KeyEqual, Allocator>& map, const std::string& path)
+{
+  static_assert(std::is_trivially_copyable<KeyType>::value && std::is_trivially_copyable<ValueType>::value,
+                "Only trivially copyable keys and values can be snapshotted!");
+
+  using entry_type = SnapshotEntry<KeyType, ValueType>;
+
+  SnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+  header.version = snapshotVersion;
+  header.keySize = sizeof(KeyType);
+  header.keyAlign = alignof(KeyType);
+  header.valueSize = sizeof(ValueType);
+  header.valueAlign = alignof(ValueType);
+  header.entryCount = map.getSize();
+  header.bucketCount = std::uint64_t(1) << log2Ceil(map.getSize() < initialBucketCount ? initialBucketCount : map.getSize());
+  header.shift = 64 - log2Ceil(header.bucketCount);
+  header.entriesOffset = snapshotEntriesOffset(header.bucketCount, alignof(entry_type));
+
+  Hash hash = map.hash_function();
+  std::vector<std::uint64_t> offsets(header.bucketCount + 1, 0);
+  std::vector<entry_type> entries(header.entryCount);   //value initialized, so padding is written as zeros
+
+  //counting sort by bucket, offsets[b] ends up as the index of bucket b's first entry
+  for(auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    offsets[fibonacciIndex(hash(it->first), header.shift) + 1]++;
+  }
+  for(std::uint64_t i = 0; i < header.bucketCount; i++)
+  {
+    offsets[i + 1] += offsets[i];
+  }
+
+  std::vector<std::uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+  for(auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    entry_type& entry = entries[cursor[fibonacciIndex(hash(it->first), header.shift)]++];
+    entry.key = it->first;
+    entry.value = it->second;
+  }
+
+  //the image is built next to path and renamed over it, so a crash or a full disk never leaves a half-written snapshot behind
+  std::string temporary = path + ".tmp";
+  int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0)
+    throw std::runtime_error("Cannot open snapshot file " + temporary + " for writing!");
+
+  std::vector<char> padding(header.entriesOffset - sizeof(header) - offsets.size() * sizeof(std::uint64_t), 0);
+
+  bool written = writeSnapshotPart(fd, &header, sizeof(header))
+                 && writeSnapshotPart(fd, offsets.data(), offsets.size() * sizeof(std::uint64_t))
+                 && writeSnapshotPart(fd, padding.data(), padding.size())
+                 && writeSnapshotPart(fd, entries.data(), entries.size() * sizeof(entry_type))
+                 && ::fsync(fd) == 0;
+
+  if(::close(fd) != 0 || !written)
+  {
+    ::unlink(temporary.c_str());
+    throw std::runtime_error("Cannot write snapshot file " + temporary + "!");
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if(error)
+  {
+    ::unlink(temporary.c_str());
+    throw std::runtime_error("Cannot replace snapshot file " + path + ": " + error.message() + "!");
+  }
+}
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class MappedHashMap //read-only view of a snapshot, lookups run straight on the mapped pages
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+private:
+  using entry_type = SnapshotEntry<KeyType, ValueType>;
+
+  const char* image;
+  size_type imageSize;
+  const SnapshotHeader* header;
+  const std::uint64_t* offsets;
+  const entry_type* entries;
+  hasher hash;
+  key_equal equal;
+
+  void validate(const std::string& path) const
+  {
+    if(imageSize < sizeof(SnapshotHeader) || std::memcmp(header->magic, snapshotMagic, sizeof(snapshotMagic)) != 0)
+      throw std::runtime_error(path + " is not a map snapshot!");
+
+    if(header->version != snapshotVersion)
+      throw std::runtime_error(path + " has unsupported snapshot version " + std::to_string(header->version) + "!");
+
+    if(header->keySize != sizeof(KeyType) || header->keyAlign != alignof(KeyType)
+       || header->valueSize != sizeof(ValueType) || header->valueAlign != alignof(ValueType))
+      throw std::runtime_error(path + " was saved with different key or value types!");
+
+    if(header->bucketCount < 2 || (header->bucketCount & (header->bucketCount - 1)) != 0
+       || header->bucketCount > imageSize / sizeof(std::uint64_t) || header->entryCount > imageSize / sizeof(entry_type)
+       || header->shift != 64 - log2Ceil(header->bucketCount)
+       || header->entriesOffset != snapshotEntriesOffset(header->bucketCount, alignof(entry_type))
+       || imageSize < header->entriesOffset + header->entryCount * sizeof(entry_type))
+      throw std::runtime_error(path + " is truncated or corrupted!");
+
+    //find trusts every bucket's range, so the offsets must rise from 0 to entryCount without a step back
+    const std::uint64_t* ends = reinterpret_cast<const std::uint64_t*>(image + sizeof(SnapshotHeader));
+    if(ends[0] != 0 || ends[header->bucketCount] != header->entryCount)
+      throw std::runtime_error(path + " is truncated or corrupted!");
+
+    for(std::uint64_t i = 0; i < header->bucketCount; i++)
+    {
+      if(ends[i] > ends[i + 1])
+        throw std::runtime_error(path + " is truncated or corrupted!");
+    }
+  }
+
+public:
+  explicit MappedHashMap(const std::string& path, const hasher& hashFunction = hasher(), const key_equal& keyEqual = key_equal())
+    : hash(hashFunction), equal(keyEqual)
+  {
+    static_assert(std::is_trivially_copyable<KeyType>::value && std::is_trivially_copyable<ValueType>::value,
+                  "Only trivially copyable keys and values can be snapshotted!");
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+      throw std::runtime_error("Cannot open snapshot file " + path + "!");
+
+    struct stat status;
+    if(::fstat(fd, &status) != 0 || status.st_size == 0)
+    {
+      ::close(fd);
+      throw std::runtime_error(path + " is not a map snapshot!");
+    }
+
+    imageSize = static_cast<size_type>(status.st_size);
+    void* mapped = ::mmap(nullptr, imageSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  //the mapping keeps the file alive
+
+    if(mapped == MAP_FAILED)
+      throw std::runtime_error("Cannot map snapshot file " + path + "!");
+
+    image = static_cast<const char*>(mapped);
+    header = reinterpret_cast<const SnapshotHeader*>(image);
+
+    try
+    {
+      validate(path);
+    }
+    catch(...)
+    {
+      ::munmap(const_cast<char*>(image), imageSize);
+      throw;
+    }
+
+    offsets = reinterpret_cast<const std::uint64_t*>(image + sizeof(SnapshotHeader));
+    entries = reinterpret_cast<const entry_type*>(image + header->entriesOffset);
+  }
+
+  MappedHashMap(const MappedHashMap&) = delete;
+  MappedHashMap& operator=(const MappedHashMap&) = delete;
+
+  ~MappedHashMap()
+  {
+    ::munmap(const_cast<char*>(image), imageSize);
+  }
+
+  const mapped_type* find(const key_type& key) const //nullptr if key is absent, the pointer lives as long as the map
+  {
+    size_type bucket = fibonacciIndex(hash(key), header->shift);
+
+    for(std::uint64_t i = offsets[bucket]; i < offsets[bucket + 1]; i++)
+    {
+      if(equal(entries[i].key, key))
+        return &entries[i].value;
+    }
+
+    return nullptr;
+  }
+
+  bool contains(const key_type& key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    const mapped_type* value = find(key);
+
+    if(value == nullptr)
+      throw std::out_of_range("Key not found!");
+
+    return *value;
+  }
+
+  template <typename F>
+  void forEach(F fn) const //fn(key, value) in bucket order
+  {
+    for(std::uint64_t i = 0; i < header->entryCount; i++)
+    {
+      fn(entries[i].key, entries[i].value);
+    }
+  }
+
+  size_type getSize() const
+  {
+    return header->entryCount;
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_HASHMAPSNAPSHOT_H */
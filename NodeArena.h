@@ -0,0 +1,194 @@
+#ifndef AISDI_MAPS_NODEARENA_H
+#define AISDI_MAPS_NODEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "Bits.h"
+
+namespace aisdi
+{
+
+  const unsigned arenaFirstChunkBits = 4;   //the first chunk holds 16 nodes, every later one as many as all before it
+  const size_t arenaMaxChunks = 32 - arenaFirstChunkBits + 1;
+
+template <typename Node>
+class NodeArena //nodes live in chunks that never move and are named by 32-bit indices, 0 is the null index
+{
+public:
+  using index_type = std::uint32_t;
+  using size_type = std::size_t;
+
+private:
+  static_assert(sizeof(Node) >= sizeof(index_type) && alignof(Node) >= alignof(index_type),
+                "A free slot must be able to hold the next free index!");
+
+  static const index_type firstChunkMask = (index_type(1) << arenaFirstChunkBits) - 1;
+
+  Node* chunks[arenaMaxChunks];
+  size_type chunkCount;
+  std::uint64_t used;     //next never used index, index 0 is never handed out
+  index_type freeList;    //a freed slot holds the index of the next free one
+  size_type live;
+
+  static size_type chunkSize(size_type chunk)
+  {
+    return chunk == 0 ? firstChunkMask + 1 : (size_type(firstChunkMask) + 1) << (chunk - 1);
+  }
+
+  static std::uint64_t capacityOf(size_type count) //indices covered by the first count chunks
+  {
+    return count == 0 ? 0 : std::uint64_t(firstChunkMask + 1) << (count - 1);
+  }
+
+  void* slot(index_type index) const
+  {
+    unsigned high = 63 - countLeadingZeros(std::uint64_t(index | firstChunkMask));
+    index_type start = (index_type(1) << high) & ~firstChunkMask;
+
+    return chunks[high - (arenaFirstChunkBits - 1)] + (index - start);
+  }
+
+  void addChunk()
+  {
+    if(chunkCount == arenaMaxChunks)
+      throw std::length_error("Node arena is full!");
+
+    chunks[chunkCount] = static_cast<Node*>(::operator new(chunkSize(chunkCount) * sizeof(Node), std::align_val_t(alignof(Node))));
+    chunkCount++;
+  }
+
+  void makeEmpty()
+  {
+    chunkCount = 0;
+    used = 1;
+    freeList = 0;
+    live = 0;
+  }
+
+public:
+  NodeArena()
+  {
+    makeEmpty();
+  }
+
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  NodeArena(NodeArena&& other) noexcept
+  {
+    makeEmpty();
+    swap(other);
+  }
+
+  NodeArena& operator=(NodeArena&& other) noexcept
+  {
+    if(this != &other)
+    {
+      release();
+      swap(other);
+    }
+
+    return *this;
+  }
+
+  ~NodeArena()
+  {
+    release();
+  }
+
+  void swap(NodeArena& other) noexcept
+  {
+    std::swap(chunks, other.chunks);
+    std::swap(chunkCount, other.chunkCount);
+    std::swap(used, other.used);
+    std::swap(freeList, other.freeList);
+    std::swap(live, other.live);
+  }
+
+  void reserve(size_type count) //allocates the chunks for count more nodes now instead of one by one later
+  {
+    while(capacityOf(chunkCount) < used + count)
+    {
+      addChunk();
+    }
+  }
+
+  template <typename... Args>
+  index_type create(Args&&... args) //while no slot was freed, indices are handed out consecutively
+  {
+    index_type index;
+
+    if(freeList != 0)
+    {
+      index = freeList;
+      freeList = *std::launder(static_cast<index_type*>(slot(index)));
+    }
+    else
+    {
+      if(used >= capacityOf(chunkCount))   //index 0 is counted as used before the first chunk exists
+        addChunk();
+
+      index = static_cast<index_type>(used++);
+    }
+
+    try
+    {
+      new (slot(index)) Node(std::forward<Args>(args)...);
+    }
+    catch(...)
+    {
+      new (slot(index)) index_type(freeList);
+      freeList = index;
+      throw;
+    }
+
+    live++;
+    return index;
+  }
+
+  void destroy(index_type index) //runs the node's destructor, the slot goes onto the free list
+  {
+    (*this)[index].~Node();
+    new (slot(index)) index_type(freeList);
+    freeList = index;
+    live--;
+  }
+
+  void release() //hands every chunk back without running destructors, live nodes must be trivially destructible or destroyed by the caller
+  {
+    for(size_type chunk = 0; chunk < chunkCount; chunk++)
+    {
+      ::operator delete(chunks[chunk], std::align_val_t(alignof(Node)));
+    }
+
+    makeEmpty();
+  }
+
+  Node& operator[](index_type index)
+  {
+    return *std::launder(static_cast<Node*>(slot(index)));
+  }
+
+  const Node& operator[](index_type index) const
+  {
+    return *std::launder(static_cast<const Node*>(slot(index)));
+  }
+
+  size_type getLiveCount() const
+  {
+    return live;
+  }
+
+  size_type getCapacity() const //slots in the allocated chunks, index 0 included
+  {
+    return static_cast<size_type>(capacityOf(chunkCount));
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_NODEARENA_H */
@@ -0,0 +1,274 @@
+#ifndef AISDI_MAPS_POOLALLOCATOR_H
+#define AISDI_MAPS_POOLALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace aisdi
+{
+
+  const size_t poolChunkBytes = 65536;
+  const size_t poolMinBlocksPerChunk = 16;
+
+class NodePool //hands out blocks of one size carved from large chunks, freed blocks are reused through a free list
+{
+private:
+  std::size_t blockSize;
+  std::size_t alignment;
+  std::size_t blocksPerChunk;
+  std::vector<char*> chunks;
+  void* freeList;
+  char* cursor;       //next never used block of the newest chunk
+  char* chunkEnd;
+  std::size_t live;
+
+  void addChunk()
+  {
+    char* chunk = static_cast<char*>(::operator new(blockSize * blocksPerChunk, std::align_val_t(alignment)));
+
+    chunks.push_back(chunk);
+    cursor = chunk;
+    chunkEnd = chunk + blockSize * blocksPerChunk;
+  }
+
+  void releaseChunks(std::size_t keep) //every block must be free, the newest keep chunks stay allocated
+  {
+    if(chunks.size() > keep)
+    {
+      for(std::size_t i = 0; i + keep < chunks.size(); i++)
+      {
+        ::operator delete(chunks[i], std::align_val_t(alignment));
+      }
+
+      chunks.erase(chunks.begin(), chunks.end() - keep);
+    }
+
+    freeList = nullptr;
+    cursor = chunks.empty() ? nullptr : chunks.back();
+    chunkEnd = chunks.empty() ? nullptr : chunks.back() + blockSize * blocksPerChunk;
+  }
+
+public:
+  static std::size_t alignmentFor(std::size_t align) //a free block stores the free list link
+  {
+    return align < alignof(void*) ? alignof(void*) : align;
+  }
+
+  static std::size_t blockSizeFor(std::size_t size, std::size_t align)
+  {
+    std::size_t padded = size < sizeof(void*) ? sizeof(void*) : size;
+    return (padded + alignmentFor(align) - 1) / alignmentFor(align) * alignmentFor(align);
+  }
+
+  NodePool(std::size_t size, std::size_t align)
+    : blockSize(blockSizeFor(size, align)), alignment(alignmentFor(align)),
+      freeList(nullptr), cursor(nullptr), chunkEnd(nullptr), live(0)
+  {
+    blocksPerChunk = poolChunkBytes / blockSize < poolMinBlocksPerChunk ? poolMinBlocksPerChunk : poolChunkBytes / blockSize;
+  }
+
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  ~NodePool()
+  {
+    for(char* chunk : chunks)
+    {
+      ::operator delete(chunk, std::align_val_t(alignment));
+    }
+  }
+
+  std::size_t getBlockSize() const
+  {
+    return blockSize;
+  }
+
+  std::size_t getAlignment() const
+  {
+    return alignment;
+  }
+
+  void* allocate()
+  {
+    live++;
+
+    if(freeList != nullptr)
+    {
+      void* block = freeList;
+      freeList = *static_cast<void**>(block);
+      return block;
+    }
+
+    if(cursor == chunkEnd)
+      addChunk();
+
+    void* block = cursor;
+    cursor += blockSize;
+    return block;
+  }
+
+  void deallocate(void* block)
+  {
+    *static_cast<void**>(block) = freeList;
+    freeList = block;
+
+    if(--live == 0) //the container is empty, give back whole chunks instead of keeping them on the free list
+      releaseChunks(1);
+  }
+};
+
+class PoolResource //one pool per block size, shared by an allocator and all of its rebound copies
+{
+private:
+  std::vector<std::unique_ptr<NodePool> > pools;
+  NodePool* recent;   //a container allocates one node type, so the last pool handed out is nearly always the one asked for
+
+  static bool fits(const NodePool* pool, std::size_t size, std::size_t alignment)
+  {
+    return pool->getBlockSize() == NodePool::blockSizeFor(size, alignment) && pool->getAlignment() == NodePool::alignmentFor(alignment);
+  }
+
+public:
+  PoolResource() : recent(nullptr)
+  {}
+
+  NodePool* poolFor(std::size_t size, std::size_t alignment)
+  {
+    if(recent != nullptr && fits(recent, size, alignment))
+      return recent;
+
+    for(auto& pool : pools)
+    {
+      if(fits(pool.get(), size, alignment))
+        return recent = pool.get();
+    }
+
+    pools.push_back(std::unique_ptr<NodePool>(new NodePool(size, alignment)));
+    return recent = pools.back().get();
+  }
+};
+
+template <typename T>
+class PoolHandle //non-owning view of a PoolResource, one pointer wide, for the many containers inside one that owns the resource
+{
+public:
+  using value_type = T;
+
+private:
+  template <typename U>
+  friend class PoolHandle;
+
+  PoolResource* resource;
+
+public:
+  explicit PoolHandle(PoolResource* poolResource) : resource(poolResource)
+  {}
+
+  template <typename U>
+  PoolHandle(const PoolHandle<U>& other) : resource(other.resource)
+  {}
+
+  T* allocate(std::size_t n)
+  {
+    if(n == 1)
+      return static_cast<T*>(resource->poolFor(sizeof(T), alignof(T))->allocate());
+
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    if(n == 1)
+      resource->poolFor(sizeof(T), alignof(T))->deallocate(p);
+    else
+      std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const PoolHandle<U>& other) const
+  {
+    return resource == other.resource;
+  }
+
+  template <typename U>
+  bool operator!=(const PoolHandle<U>& other) const
+  {
+    return resource != other.resource;
+  }
+};
+
+template <typename T>
+class PoolAllocator //single element requests come from the pool, arrays go to operator new, not thread safe
+{
+public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using handle_type = PoolHandle<T>;   //what a container hands to the containers it owns instead of copies of this allocator
+
+private:
+  template <typename U>
+  friend class PoolAllocator;
+
+  std::shared_ptr<PoolResource> resource;
+  NodePool* pool;
+
+public:
+  PoolAllocator()
+    : resource(std::make_shared<PoolResource>())
+  {
+    pool = resource->poolFor(sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& other)
+    : resource(other.resource)
+  {
+    pool = resource->poolFor(sizeof(T), alignof(T));
+  }
+
+  T* allocate(std::size_t n)
+  {
+    if(n == 1)
+      return static_cast<T*>(pool->allocate());
+
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    if(n == 1)
+      pool->deallocate(p);
+    else
+      std::allocator<T>().deallocate(p, n);
+  }
+
+  PoolAllocator select_on_container_copy_construction() const //a copied container gets pools of its own
+  {
+    return PoolAllocator();
+  }
+
+  handle_type handle() const //valid while this allocator or a copy sharing its resource is alive
+  {
+    return handle_type(resource.get());
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& other) const
+  {
+    return resource == other.resource;
+  }
+
+  template <typename U>
+  bool operator!=(const PoolAllocator<U>& other) const
+  {
+    return resource != other.resource;
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_POOLALLOCATOR_H */
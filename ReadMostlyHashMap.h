@@ -0,0 +1,332 @@
+#ifndef AISDI_MAPS_READMOSTLYHASHMAP_H
+#define AISDI_MAPS_READMOSTLYHASHMAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <functional>
+#include <initializer_list>
+
+#include "Hash.h"
+#include "EpochReclamation.h"
+
+namespace aisdi
+{
+
+  const size_t readMostlyInitialBucketCount = 16;
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class ReadMostlyHashMap //lookups take no lock, writers are serialized and publish whole nodes, unlinked memory is freed by epochs
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+private:
+  struct Node //never modified after publishing except for the link, an assignment publishes a replacement
+  {
+    const value_type value;
+    std::atomic<Node*> next;
+
+    template <typename... Args>
+    explicit Node(Node* following, Args&&... args)
+      : value(std::forward<Args>(args)...), next(following)
+    {}
+  };
+
+  struct Table //same power of two chaining as HashMap, a resize builds a new table instead of relinking nodes readers may be on
+  {
+    std::atomic<Node*>* buckets;
+    size_type bucketCount;
+    unsigned shift;
+
+    explicit Table(size_type count)
+      : buckets(new std::atomic<Node*>[count]), bucketCount(count), shift(64 - log2Ceil(count))
+    {
+      for(size_type i = 0; i < bucketCount; i++)
+      {
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    ~Table()
+    {
+      delete[] buckets;
+    }
+
+    std::atomic<Node*>& bucketFor(size_type keyHash) const
+    {
+      return buckets[fibonacciIndex(keyHash, shift)];
+    }
+  };
+
+  std::atomic<Table*> table;
+  std::atomic<size_type> size;
+  std::mutex writeLock;
+  std::vector<std::pair<std::uint64_t, Node*> > retiredNodes;     //guarded by writeLock
+  std::vector<std::pair<std::uint64_t, Table*> > retiredTables;
+  hasher hash;
+  key_equal equal;
+
+  const Node* findNode(const Table* current, const key_type& key) const //caller holds an epoch guard or the write lock
+  {
+    for(const Node* node = current->bucketFor(hash(key)).load(std::memory_order_acquire); node != nullptr;
+        node = node->next.load(std::memory_order_acquire))
+    {
+      if(equal(node->value.first, key))
+        return node;
+    }
+
+    return nullptr;
+  }
+
+  std::atomic<Node*>* linkTo(Table* current, const key_type& key) //the link pointing at key's node, or at the chain's end
+  {
+    std::atomic<Node*>* link = &current->bucketFor(hash(key));
+
+    for(Node* node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed))
+    {
+      if(equal(node->value.first, key))
+        return link;
+
+      link = &node->next;
+    }
+
+    return link;
+  }
+
+  void retire(Node* node)
+  {
+    retiredNodes.emplace_back(EpochDomain::instance().retireEpoch(), node);
+  }
+
+  void reclaim() //frees what no reader can still reach, must be called with the write lock held
+  {
+    EpochDomain& domain = EpochDomain::instance();
+
+    domain.advance();
+    std::uint64_t oldest = domain.oldestActive();
+
+    size_type kept = 0;
+    for(auto& retired : retiredNodes)
+    {
+      if(retired.first < oldest)
+        delete retired.second;
+      else
+        retiredNodes[kept++] = retired;
+    }
+    retiredNodes.resize(kept);
+
+    kept = 0;
+    for(auto& retired : retiredTables)
+    {
+      if(retired.first < oldest)
+        delete retired.second;
+      else
+        retiredTables[kept++] = retired;
+    }
+    retiredTables.resize(kept);
+  }
+
+  void grow(Table* current) //copies every node into a table twice as large, the old table and nodes are retired
+  {
+    Table* bigger = new Table(current->bucketCount * 2);
+
+    for(size_type i = 0; i < current->bucketCount; i++)
+    {
+      for(Node* node = current->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+          node = node->next.load(std::memory_order_relaxed))
+      {
+        std::atomic<Node*>& bucket = bigger->bucketFor(hash(node->value.first));
+        bucket.store(new Node(bucket.load(std::memory_order_relaxed), node->value), std::memory_order_relaxed);
+        retire(node);
+      }
+    }
+
+    table.store(bigger, std::memory_order_release);
+    retiredTables.emplace_back(EpochDomain::instance().retireEpoch(), current);
+  }
+
+  template <typename... Args>
+  bool publish(const key_type& key, bool replace, Args&&... args) //true if the key was not present before
+  {
+    std::lock_guard<std::mutex> guard(writeLock);
+
+    Table* current = table.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = linkTo(current, key);
+    Node* existing = link->load(std::memory_order_relaxed);
+
+    if(existing != nullptr)
+    {
+      if(!replace)
+        return false;
+
+      link->store(new Node(existing->next.load(std::memory_order_relaxed), std::forward<Args>(args)...), std::memory_order_release);
+      retire(existing);
+      reclaim();
+      return false;
+    }
+
+    std::atomic<Node*>& bucket = current->bucketFor(hash(key));
+    bucket.store(new Node(bucket.load(std::memory_order_relaxed), std::forward<Args>(args)...), std::memory_order_release);
+
+    if(size.fetch_add(1, std::memory_order_relaxed) + 1 > current->bucketCount)
+    {
+      grow(current);
+      reclaim();
+    }
+
+    return true;
+  }
+
+public:
+  explicit ReadMostlyHashMap(const hasher& hashFunction = hasher(), const key_equal& keyEqual = key_equal())
+    : table(new Table(readMostlyInitialBucketCount)), size(0), hash(hashFunction), equal(keyEqual)
+  {}
+
+  ReadMostlyHashMap(std::initializer_list<value_type> list)
+    : ReadMostlyHashMap()
+  {
+    for(auto& element : list)
+    {
+      try_emplace(element.first, element.second);
+    }
+  }
+
+  ReadMostlyHashMap(const ReadMostlyHashMap&) = delete;
+  ReadMostlyHashMap& operator=(const ReadMostlyHashMap&) = delete;
+
+  ~ReadMostlyHashMap() //no reader may still be inside the map
+  {
+    Table* current = table.load(std::memory_order_relaxed);
+
+    for(size_type i = 0; i < current->bucketCount; i++)
+    {
+      Node* node = current->buckets[i].load(std::memory_order_relaxed);
+
+      while(node != nullptr)
+      {
+        Node* next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        node = next;
+      }
+    }
+
+    delete current;
+
+    for(auto& retired : retiredNodes)
+    {
+      delete retired.second;
+    }
+
+    for(auto& retired : retiredTables)
+    {
+      delete retired.second;
+    }
+  }
+
+  std::optional<mapped_type> find(const key_type& key) const
+  {
+    EpochDomain::Guard guard;
+
+    const Node* node = findNode(table.load(std::memory_order_acquire), key);
+
+    if(node == nullptr)
+      return std::nullopt;
+
+    return node->value.second;
+  }
+
+  bool contains(const key_type& key) const
+  {
+    EpochDomain::Guard guard;
+
+    return findNode(table.load(std::memory_order_acquire), key) != nullptr;
+  }
+
+  mapped_type valueOf(const key_type& key) const
+  {
+    std::optional<mapped_type> value = find(key);
+
+    if(!value)
+      throw std::out_of_range("Key not found!");
+
+    return *value;
+  }
+
+  template <typename M>
+  bool insert_or_assign(const key_type& key, M&& value) //true if the key was not present before
+  {
+    return publish(key, true, key, std::forward<M>(value));
+  }
+
+  template <typename... Args>
+  bool try_emplace(const key_type& key, Args&&... args) //true if inserted, an existing value is left alone
+  {
+    return publish(key, false, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  bool remove(const key_type& key) //false if the key was not present
+  {
+    std::lock_guard<std::mutex> guard(writeLock);
+
+    std::atomic<Node*>* link = linkTo(table.load(std::memory_order_relaxed), key);
+    Node* existing = link->load(std::memory_order_relaxed);
+
+    if(existing == nullptr)
+      return false;
+
+    link->store(existing->next.load(std::memory_order_relaxed), std::memory_order_release);
+    size.fetch_sub(1, std::memory_order_relaxed);
+    retire(existing);
+    reclaim();
+    return true;
+  }
+
+  template <typename F>
+  void forEach(F fn) const //lock free walk, entries changed meanwhile may or may not be seen
+  {
+    EpochDomain::Guard guard;
+
+    const Table* current = table.load(std::memory_order_acquire);
+
+    for(size_type i = 0; i < current->bucketCount; i++)
+    {
+      for(const Node* node = current->buckets[i].load(std::memory_order_acquire); node != nullptr;
+          node = node->next.load(std::memory_order_acquire))
+      {
+        fn(node->value);
+      }
+    }
+  }
+
+  size_type getSize() const //exact only while no writer is running
+  {
+    return size.load(std::memory_order_relaxed);
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  size_type getPendingReclamation() //retired nodes and tables still waiting for readers to leave
+  {
+    std::lock_guard<std::mutex> guard(writeLock);
+
+    return retiredNodes.size() + retiredTables.size();
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_READMOSTLYHASHMAP_H */
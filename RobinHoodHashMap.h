@@ -0,0 +1,708 @@
+#ifndef AISDI_MAPS_ROBINHOODHASHMAP_H
+#define AISDI_MAPS_ROBINHOODHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <new>
+#include <functional>
+#include <vector>
+
+#include "Hash.h"
+
+namespace aisdi
+{
+
+  const size_t robinHoodInitialBucketCount = 16;
+  const float robinHoodMaxLoadFactor = 0.875f;
+  const size_t robinHoodBaseProbeLimit = 16;    //plus four per table size bit, far above what random keys reach at full load
+  const size_t robinHoodMaxProbeLimit = 255;    //distances are stored in a byte
+  const std::uint64_t robinHoodSeedStep = 0x9e3779b97f4a7c15ull;
+
+//a key that cannot sit within probeLimit of its home, even after one reseed, goes to a small overflow list instead of
+//failing the insert; the list is only searched from homes that overflowed, so a weak Hash slows those keys like a long
+//chain would and leaves every other lookup alone
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class RobinHoodHashMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  value_type* slots;          //bucketCount + probeLimit slots, the tail takes overflow so probes never wrap around
+  unsigned char* distances;   //0 marks an empty slot, otherwise distance from the home slot + 1
+  size_type bucketCount;
+  size_type probeLimit;
+  unsigned shift;
+  std::uint64_t seed;         //0 until keys crowding one probe sequence forced a reseed
+  std::vector<value_type> overflow;       //entries past the probe limit, iterator positions slotCount() and on
+  std::vector<std::uint64_t> overflowed;  //bit h is set once an entry with home h went to overflow, empty while overflow is
+  size_type size;
+  hasher hash;
+  key_equal equal;
+
+  size_type slotCount() const
+  {
+    return bucketCount + probeLimit;
+  }
+
+  size_type endIndex() const //iterator positions cover the slots, then the overflow list
+  {
+    return slotCount() + overflow.size();
+  }
+
+  value_type& entryAt(size_type index) const
+  {
+    return index < slotCount() ? slots[index] : const_cast<value_type&>(overflow[index - slotCount()]);
+  }
+
+  bool hasOverflowed(size_type home) const
+  {
+    return !overflowed.empty() && (overflowed[home / 64] >> (home % 64)) & 1u;
+  }
+
+  size_type homeSlot(const key_type& key) const
+  {
+    std::uint64_t keyHash = static_cast<std::uint64_t>(hash(key));
+
+    return fibonacciIndex(seed == 0 ? keyHash : mix64(keyHash ^ seed), shift);
+  }
+
+  void allocate(size_type newBucketCount)
+  {
+    unsigned bits = log2Ceil(newBucketCount < robinHoodInitialBucketCount ? robinHoodInitialBucketCount : newBucketCount);
+
+    bucketCount = size_type(1) << bits;
+    shift = 64 - bits;
+    probeLimit = robinHoodBaseProbeLimit + 4 * bits;
+    if(probeLimit > robinHoodMaxProbeLimit)
+      probeLimit = robinHoodMaxProbeLimit;
+    slots = std::allocator<value_type >().allocate(slotCount());
+    distances = new unsigned char[slotCount()]();
+  }
+
+  void release()
+  {
+    if(slots == nullptr)
+      return;
+
+    for(size_type i = 0; i < slotCount(); i++)
+    {
+      if(distances[i] != 0)
+        slots[i].~value_type();
+    }
+
+    std::allocator<value_type >().deallocate(slots, slotCount());
+    delete[] distances;
+  }
+
+  size_type findSlot(const key_type& key) const //returns endIndex() if key is not present
+  {
+    if(size == 0)   //also covers a moved-from map, which has no table
+      return endIndex();
+
+    size_type home = homeSlot(key);
+    size_type index = home;
+
+    for(size_type distance = 1; distances[index] >= distance; index++, distance++)
+    {
+      if(equal(slots[index].first, key))
+        return index;
+    }
+
+    if(hasOverflowed(home))
+    {
+      for(size_type i = 0; i < overflow.size(); i++)
+      {
+        if(equal(overflow[i].first, key))
+          return slotCount() + i;
+      }
+    }
+
+    return endIndex();
+  }
+
+  bool canShift(size_type from, size_type to) const //whether slots [from, to) may move one step further from home
+  {
+    if(to == slotCount())
+      return false;
+
+    for(size_type i = from; i < to; i++)
+    {
+      if(distances[i] == probeLimit)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool findPlace(size_type home, size_type& index, size_type& empty) const //false if an entry at home would push some entry past probeLimit
+  {
+    size_type distance = 1;
+
+    index = home;
+    while(distances[index] >= distance) //richer entries keep their slots
+    {
+      index++;
+      distance++;
+    }
+
+    empty = index;
+    while(empty < slotCount() && distances[empty] != 0)
+    {
+      empty++;
+    }
+
+    return distance <= probeLimit && canShift(index, empty);
+  }
+
+  void placeDistance(size_type home, size_type index, size_type empty) //records an entry at index, the ones in [index, empty) move on by one
+  {
+    for(size_type i = empty; i > index; i--)
+    {
+      distances[i] = distances[i - 1] + 1;
+    }
+
+    distances[index] = static_cast<unsigned char>(index - home + 1);
+  }
+
+  size_type insertSlot(value_type&& val) //key must be absent, returns the slot it was placed in or slotCount(), leaving val alone, if it does not fit
+  {
+    size_type home = homeSlot(val.first);
+    size_type index;
+    size_type empty;
+
+    if(!findPlace(home, index, empty))
+      return slotCount();
+
+    if(empty == index)
+    {
+      new (slots + index) value_type(std::move(val));
+    }
+    else
+    {
+      new (slots + empty) value_type(std::move(slots[empty - 1]));
+
+      for(size_type i = empty - 1; i > index; i--)
+      {
+        slots[i] = std::move(slots[i - 1]);
+      }
+
+      slots[index] = std::move(val);
+    }
+
+    placeDistance(home, index, empty);
+    return index;
+  }
+
+  size_type overflowSlot(value_type&& val) //returns val's position in the overflow list
+  {
+    size_type home = homeSlot(val.first);
+
+    if(overflowed.empty())
+      overflowed.assign((bucketCount + 63) / 64, 0);
+
+    overflow.push_back(std::move(val));
+    overflowed[home / 64] |= std::uint64_t(1) << (home % 64);
+    return slotCount() + overflow.size() - 1;
+  }
+
+  void removeSlot(size_type index) //backward shift deletion, no tombstones are left behind
+  {
+    if(index >= slotCount())
+    {
+      //the last overflow entry fills the hole, home bits stay set until the next rehash clears them
+      if(index - slotCount() != overflow.size() - 1)
+        overflow[index - slotCount()] = std::move(overflow.back());
+
+      overflow.pop_back();
+      size--;
+      return;
+    }
+
+    size_type next = index + 1;
+
+    while(next < slotCount() && distances[next] > 1)
+    {
+      slots[next - 1] = std::move(slots[next]);
+      distances[next - 1] = distances[next] - 1;
+      next++;
+    }
+
+    slots[next - 1].~value_type();
+    distances[next - 1] = 0;
+    size--;
+  }
+
+  void rehash(size_type newBucketCount, std::uint64_t newSeed) //entries that no longer fit within the probe limit go to overflow
+  {
+    value_type* oldSlots = slots;
+    unsigned char* oldDistances = distances;
+    size_type oldSlotCount = slotCount();
+    std::vector<value_type> oldOverflow;
+
+    oldOverflow.swap(overflow);
+    overflowed.clear();
+    allocate(newBucketCount);
+    seed = newSeed;
+
+    for(size_type i = 0; i < oldSlotCount; i++)
+    {
+      if(oldDistances[i] != 0)
+      {
+        if(insertSlot(std::move(oldSlots[i])) == slotCount())
+          overflowSlot(std::move(oldSlots[i]));
+
+        oldSlots[i].~value_type();
+      }
+    }
+
+    for(value_type& entry : oldOverflow)
+    {
+      if(insertSlot(std::move(entry)) == slotCount())
+        overflowSlot(std::move(entry));
+    }
+
+    if(oldSlots != nullptr)
+      std::allocator<value_type >().deallocate(oldSlots, oldSlotCount);
+    delete[] oldDistances;
+  }
+
+  size_type insert(value_type val)
+  {
+    //the table grows on load alone, a crowded probe sequence gets one reseed before its keys start to overflow
+    if(size + 1 > bucketCount * robinHoodMaxLoadFactor)
+      rehash(bucketCount == 0 ? robinHoodInitialBucketCount : bucketCount * 2, seed);
+
+    size_type index = insertSlot(std::move(val));
+
+    if(index == slotCount() && overflow.empty())
+    {
+      rehash(bucketCount, seed + robinHoodSeedStep);
+      index = insertSlot(std::move(val));
+    }
+
+    if(index == slotCount())
+      index = overflowSlot(std::move(val));
+
+    size++;
+    return index;
+  }
+
+  size_type firstFrom(size_type index) const //first occupied slot or overflow entry at or after index
+  {
+    while(index < slotCount() && distances[index] == 0)
+    {
+      index++;
+    }
+
+    return index < endIndex() ? index : endIndex();
+  }
+
+  size_type lastBefore(size_type index) const //last full position before index, endIndex() if there is none
+  {
+    if(index > slotCount())
+      return index - 1;
+
+    while(index > 0)
+    {
+      if(distances[--index] != 0)
+        return index;
+    }
+
+    return endIndex();
+  }
+
+public:
+  RobinHoodHashMap() : seed(0), size(0)
+  {
+    allocate(robinHoodInitialBucketCount);
+  }
+
+  explicit RobinHoodHashMap(const hasher& hashFunction, const key_equal& keyEqual = key_equal())
+    : seed(0), size(0), hash(hashFunction), equal(keyEqual)
+  {
+    allocate(robinHoodInitialBucketCount);
+  }
+
+  RobinHoodHashMap(std::initializer_list<value_type> list) : seed(0), size(0)
+  {
+    allocate(robinHoodInitialBucketCount);
+
+    for(auto it = list.begin(); it != list.end(); ++it)
+    {
+      if(findSlot(it->first) == endIndex())
+        insert(*it);
+    }
+  }
+
+  RobinHoodHashMap(const RobinHoodHashMap& other) : seed(other.seed), size(0), hash(other.hash), equal(other.equal)
+  {
+    allocate(other.bucketCount);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+  }
+
+  RobinHoodHashMap(RobinHoodHashMap&& other) noexcept
+    : overflow(std::move(other.overflow)), overflowed(std::move(other.overflowed)), hash(other.hash), equal(other.equal)
+  {
+    slots = other.slots;
+    distances = other.distances;
+    bucketCount = other.bucketCount;
+    probeLimit = other.probeLimit;
+    shift = other.shift;
+    seed = other.seed;
+    size = other.size;
+
+    //the moved-from map keeps no table and allocates one on its first insert, so nothing here can throw
+    other.slots = nullptr;
+    other.distances = nullptr;
+    other.bucketCount = 0;
+    other.probeLimit = 0;
+    other.seed = 0;
+    other.overflow.clear();
+    other.overflowed.clear();
+    other.size = 0;
+  }
+
+  ~RobinHoodHashMap()
+  {
+    release();
+  }
+
+  RobinHoodHashMap& operator=(const RobinHoodHashMap& other)
+  {
+    if(this == &other)
+      return *this;
+
+    release();
+    overflow.clear();
+    overflowed.clear();
+    size = 0;
+    seed = other.seed;
+    hash = other.hash;
+    equal = other.equal;
+    allocate(other.bucketCount);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+
+    return *this;
+  }
+
+  RobinHoodHashMap& operator=(RobinHoodHashMap&& other) noexcept
+  {
+    if(this == &other)
+      return *this;
+
+    std::swap(slots, other.slots);
+    std::swap(distances, other.distances);
+    std::swap(bucketCount, other.bucketCount);
+    std::swap(probeLimit, other.probeLimit);
+    std::swap(shift, other.shift);
+    std::swap(seed, other.seed);
+    overflow.swap(other.overflow);
+    overflowed.swap(other.overflowed);
+    std::swap(size, other.size);
+    std::swap(hash, other.hash);
+    std::swap(equal, other.equal);
+
+    return *this;
+  }
+
+  hasher hash_function() const
+  {
+    return hash;
+  }
+
+  key_equal key_eq() const
+  {
+    return equal;
+  }
+
+  bool isEmpty() const
+  {
+    return size == 0;
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      index = insert(value_type(key, mapped_type()));
+
+    return entryAt(index).second;
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Key not found!");
+
+    return entryAt(index).second;
+  }
+
+  mapped_type& valueOf(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Key not found!");
+
+    return entryAt(index).second;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    return ConstIterator(const_cast<RobinHoodHashMap *>(this), findSlot(key));
+  }
+
+  iterator find(const key_type& key)
+  {
+    return Iterator(this, findSlot(key));
+  }
+
+  void remove(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == endIndex())
+      throw std::out_of_range("Attempt to remove by wrong key!");
+
+    removeSlot(index);
+  }
+
+  iterator remove(const const_iterator& it) //entries shift back on removal and the last overflow entry fills an overflow hole, so iterate with it = remove(it)
+  {
+    if(it == cend())
+      throw std::out_of_range("Attempt to remove end iterator!");
+
+    removeSlot(it.index);
+
+    return Iterator(this, firstFrom(it.index));
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  bool operator==(const RobinHoodHashMap& other) const
+  {
+    if(size != other.size)
+      return false;
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      size_type index = findSlot(it->first);
+
+      if(index == endIndex() || entryAt(index).second != it->second)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const RobinHoodHashMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return Iterator(this, firstFrom(0));
+  }
+
+  iterator end()
+  {
+    return Iterator(this, endIndex());
+  }
+
+  const_iterator cbegin() const
+  {
+    return ConstIterator(const_cast<RobinHoodHashMap *>(this), firstFrom(0));
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(const_cast<RobinHoodHashMap *>(this), endIndex());
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class RobinHoodHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename RobinHoodHashMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename RobinHoodHashMap::value_type;
+  using pointer = const typename RobinHoodHashMap::value_type*;
+
+protected:
+  friend class RobinHoodHashMap;
+
+  RobinHoodHashMap* collection;
+  size_type index;
+
+public:
+  explicit ConstIterator(RobinHoodHashMap* coll, size_type newIndex)
+    : collection(coll), index(newIndex)
+  {}
+
+  ConstIterator() : collection(nullptr), index(0)
+  {}
+
+  ConstIterator(const ConstIterator& other) = default;
+  ConstIterator& operator=(const ConstIterator& other) = default;
+
+  ConstIterator& operator++()
+  {
+    if(index == collection->endIndex())
+      throw std::out_of_range("Attempt to reach past end iterator!");
+
+    index = collection->firstFrom(index + 1);
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator org = *this;
+    ++(*this);
+    return org;
+  }
+
+  ConstIterator& operator--()
+  {
+    size_type previous = collection->lastBefore(index);
+
+    if(previous == collection->endIndex())
+      throw std::out_of_range("Attempt to reach before first element!");
+
+    index = previous;
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator org = *this;
+    --(*this);
+    return org;
+  }
+
+  reference operator*() const
+  {
+    if(index == collection->endIndex())
+      throw std::out_of_range("Attempt to dereference end iterator!");
+
+    return collection->entryAt(index);
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return collection == other.collection && index == other.index;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class RobinHoodHashMap<KeyType, ValueType, Hash, KeyEqual>::Iterator : public RobinHoodHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename RobinHoodHashMap::reference;
+  using pointer = typename RobinHoodHashMap::value_type*;
+
+  explicit Iterator(RobinHoodHashMap* coll, size_type newIndex)
+    : ConstIterator(coll, newIndex)
+  {}
+
+  Iterator() : ConstIterator()
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_ROBINHOODHASHMAP_H */
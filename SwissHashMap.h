@@ -0,0 +1,622 @@
+#ifndef AISDI_MAPS_SWISSHASHMAP_H
+#define AISDI_MAPS_SWISSHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <functional>
+
+#include "Hash.h"
+#include "Bits.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace aisdi
+{
+
+  const size_t swissGroupWidth = 16;
+  const size_t swissInitialCapacity = 16;
+  const signed char swissCtrlEmpty = -128;
+  const signed char swissCtrlDeleted = -2;
+
+template <typename KeyType, typename ValueType, typename Hash = DefaultHash<KeyType>, typename KeyEqual = std::equal_to<KeyType> >
+class SwissHashMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair< key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  value_type* slots;
+  signed char* ctrl;        //one byte per slot: empty, deleted, or the low 7 bits of the hash of a full slot
+  size_type capacity;       //multiple of swissGroupWidth, a power of two
+  size_type growthLeft;     //empty slots that may still be taken before the table has to be rebuilt
+  size_type size;
+  hasher hash;
+  key_equal equal;
+
+  static std::uint32_t match(const signed char* group, signed char value) //bit i set if group[i] == value
+  {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), bytes)));
+#else
+    std::uint32_t mask = 0;
+    for(size_type i = 0; i < swissGroupWidth; i++)
+    {
+      if(group[i] == value)
+        mask |= 1u << i;
+    }
+    return mask;
+#endif
+  }
+
+  static std::uint32_t matchFree(const signed char* group) //bit i set if group[i] is empty or deleted
+  {
+#ifdef __SSE2__
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    std::uint32_t mask = 0;
+    for(size_type i = 0; i < swissGroupWidth; i++)
+    {
+      if(group[i] < 0)
+        mask |= 1u << i;
+    }
+    return mask;
+#endif
+  }
+
+  std::uint64_t hashOf(const key_type& key) const //spreads the hash so both the group index and the fragment get good bits
+  {
+    std::uint64_t mixed = static_cast<std::uint64_t>(hash(key)) * 11400714819323198485ull;
+    return mixed ^ (mixed >> 32);
+  }
+
+  size_type groupMask() const
+  {
+    return capacity / swissGroupWidth - 1;
+  }
+
+  void allocate(size_type newCapacity)
+  {
+    capacity = swissInitialCapacity;
+
+    while(capacity < newCapacity)
+    {
+      capacity *= 2;
+    }
+
+    slots = std::allocator<value_type >().allocate(capacity);
+    ctrl = new signed char[capacity];
+
+    for(size_type i = 0; i < capacity; i++)
+    {
+      ctrl[i] = swissCtrlEmpty;
+    }
+
+    growthLeft = capacity - capacity / 8 - size;
+  }
+
+  void release()
+  {
+    if(slots == nullptr)
+      return;
+
+    for(size_type i = 0; i < capacity; i++)
+    {
+      if(ctrl[i] >= 0)
+        slots[i].~value_type();
+    }
+
+    std::allocator<value_type >().deallocate(slots, capacity);
+    delete[] ctrl;
+  }
+
+  size_type findSlot(const key_type& key) const //returns capacity if key is not present
+  {
+    if(size == 0)   //also covers a moved-from map, which has no table
+      return capacity;
+
+    std::uint64_t keyHash = hashOf(key);
+    signed char fragment = static_cast<signed char>(keyHash & 0x7F);
+    size_type group = static_cast<size_type>(keyHash >> 7) & groupMask();
+
+    for(size_type step = 1; ; step++)
+    {
+      const signed char* groupCtrl = ctrl + group * swissGroupWidth;
+
+      for(std::uint32_t mask = match(groupCtrl, fragment); mask != 0; mask &= mask - 1)
+      {
+        size_type index = group * swissGroupWidth + countTrailingZeros(mask);
+
+        if(equal(slots[index].first, key))
+          return index;
+      }
+
+      if(match(groupCtrl, swissCtrlEmpty) != 0) //an empty slot ends every probe sequence that reaches it
+        return capacity;
+
+      group = (group + step) & groupMask();
+    }
+  }
+
+  size_type freeSlot(std::uint64_t keyHash) const //first empty or deleted slot on the probe sequence of keyHash
+  {
+    size_type group = static_cast<size_type>(keyHash >> 7) & groupMask();
+
+    for(size_type step = 1; ; step++)
+    {
+      std::uint32_t mask = matchFree(ctrl + group * swissGroupWidth);
+
+      if(mask != 0)
+        return group * swissGroupWidth + countTrailingZeros(mask);
+
+      group = (group + step) & groupMask();
+    }
+  }
+
+  void rehash(size_type newCapacity) //also drops every tombstone
+  {
+    value_type* oldSlots = slots;
+    signed char* oldCtrl = ctrl;
+    size_type oldCapacity = capacity;
+
+    allocate(newCapacity);
+
+    for(size_type i = 0; i < oldCapacity; i++)
+    {
+      if(oldCtrl[i] >= 0)
+      {
+        size_type index = freeSlot(hashOf(oldSlots[i].first));
+        ctrl[index] = oldCtrl[i];
+        new (slots + index) value_type(std::move(oldSlots[i]));
+        oldSlots[i].~value_type();
+      }
+    }
+
+    if(oldSlots != nullptr)
+      std::allocator<value_type >().deallocate(oldSlots, oldCapacity);
+    delete[] oldCtrl;
+  }
+
+  size_type insert(value_type val) //key must be absent, returns the slot it was placed in
+  {
+    if(growthLeft == 0)
+      rehash(size + 1 > capacity * 7 / 16 ? capacity * 2 : capacity);
+
+    std::uint64_t keyHash = hashOf(val.first);
+    size_type index = freeSlot(keyHash);
+
+    if(ctrl[index] == swissCtrlEmpty)
+      growthLeft--;
+
+    ctrl[index] = static_cast<signed char>(keyHash & 0x7F);
+    new (slots + index) value_type(std::move(val));
+    size++;
+
+    return index;
+  }
+
+  void removeSlot(size_type index)
+  {
+    const signed char* groupCtrl = ctrl + (index / swissGroupWidth) * swissGroupWidth;
+
+    //a group that still has an empty slot was never full, so no probe sequence continues past it
+    if(match(groupCtrl, swissCtrlEmpty) != 0)
+    {
+      ctrl[index] = swissCtrlEmpty;
+      growthLeft++;
+    }
+    else
+    {
+      ctrl[index] = swissCtrlDeleted;
+    }
+
+    slots[index].~value_type();
+    size--;
+  }
+
+  size_type firstFrom(size_type index) const //first full slot at or after index
+  {
+    while(index < capacity)
+    {
+      size_type group = index / swissGroupWidth;
+      std::uint32_t mask = ~matchFree(ctrl + group * swissGroupWidth) & 0xFFFFu;
+
+      mask &= 0xFFFFu << (index % swissGroupWidth);
+
+      if(mask != 0)
+        return group * swissGroupWidth + countTrailingZeros(mask);
+
+      index = (group + 1) * swissGroupWidth;
+    }
+
+    return capacity;
+  }
+
+public:
+  SwissHashMap() : size(0)
+  {
+    allocate(swissInitialCapacity);
+  }
+
+  explicit SwissHashMap(const hasher& hashFunction, const key_equal& keyEqual = key_equal())
+    : size(0), hash(hashFunction), equal(keyEqual)
+  {
+    allocate(swissInitialCapacity);
+  }
+
+  SwissHashMap(std::initializer_list<value_type> list) : size(0)
+  {
+    allocate(swissInitialCapacity);
+
+    for(auto it = list.begin(); it != list.end(); ++it)
+    {
+      if(findSlot(it->first) == capacity)
+        insert(*it);
+    }
+  }
+
+  SwissHashMap(const SwissHashMap& other) : size(0), hash(other.hash), equal(other.equal)
+  {
+    allocate(other.capacity);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+  }
+
+  SwissHashMap(SwissHashMap&& other) noexcept : hash(other.hash), equal(other.equal)
+  {
+    slots = other.slots;
+    ctrl = other.ctrl;
+    capacity = other.capacity;
+    growthLeft = other.growthLeft;
+    size = other.size;
+
+    //the moved-from map keeps no table and allocates one on its first insert, so nothing here can throw
+    other.slots = nullptr;
+    other.ctrl = nullptr;
+    other.capacity = 0;
+    other.growthLeft = 0;
+    other.size = 0;
+  }
+
+  ~SwissHashMap()
+  {
+    release();
+  }
+
+  SwissHashMap& operator=(const SwissHashMap& other)
+  {
+    if(this == &other)
+      return *this;
+
+    release();
+    size = 0;
+    hash = other.hash;
+    equal = other.equal;
+    allocate(other.capacity);
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      insert(*it);
+    }
+
+    return *this;
+  }
+
+  SwissHashMap& operator=(SwissHashMap&& other) noexcept
+  {
+    if(this == &other)
+      return *this;
+
+    std::swap(slots, other.slots);
+    std::swap(ctrl, other.ctrl);
+    std::swap(capacity, other.capacity);
+    std::swap(growthLeft, other.growthLeft);
+    std::swap(size, other.size);
+    std::swap(hash, other.hash);
+    std::swap(equal, other.equal);
+
+    return *this;
+  }
+
+  hasher hash_function() const
+  {
+    return hash;
+  }
+
+  key_equal key_eq() const
+  {
+    return equal;
+  }
+
+  bool isEmpty() const
+  {
+    return size == 0;
+  }
+
+  mapped_type& operator[](const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == capacity)
+      index = insert(value_type(key, mapped_type()));
+
+    return slots[index].second;
+  }
+
+  const mapped_type& valueOf(const key_type& key) const
+  {
+    size_type index = findSlot(key);
+
+    if(index == capacity)
+      throw std::out_of_range("Key not found!");
+
+    return slots[index].second;
+  }
+
+  mapped_type& valueOf(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == capacity)
+      throw std::out_of_range("Key not found!");
+
+    return slots[index].second;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    return ConstIterator(const_cast<SwissHashMap *>(this), findSlot(key));
+  }
+
+  iterator find(const key_type& key)
+  {
+    return Iterator(this, findSlot(key));
+  }
+
+  void remove(const key_type& key)
+  {
+    size_type index = findSlot(key);
+
+    if(index == capacity)
+      throw std::out_of_range("Attempt to remove by wrong key!");
+
+    removeSlot(index);
+  }
+
+  iterator remove(const const_iterator& it)
+  {
+    if(it == cend())
+      throw std::out_of_range("Attempt to remove end iterator!");
+
+    removeSlot(it.index);
+
+    return Iterator(this, firstFrom(it.index + 1));
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  bool operator==(const SwissHashMap& other) const
+  {
+    if(size != other.size)
+      return false;
+
+    for(auto it = other.cbegin(); it != other.cend(); ++it)
+    {
+      size_type index = findSlot(it->first);
+
+      if(index == capacity || slots[index].second != it->second)
+        return false;
+    }
+
+    return true;
+  }
+
+  bool operator!=(const SwissHashMap& other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return Iterator(this, firstFrom(0));
+  }
+
+  iterator end()
+  {
+    return Iterator(this, capacity);
+  }
+
+  const_iterator cbegin() const
+  {
+    return ConstIterator(const_cast<SwissHashMap *>(this), firstFrom(0));
+  }
+
+  const_iterator cend() const
+  {
+    return ConstIterator(const_cast<SwissHashMap *>(this), capacity);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class SwissHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename SwissHashMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename SwissHashMap::value_type;
+  using pointer = const typename SwissHashMap::value_type*;
+
+protected:
+  friend class SwissHashMap;
+
+  SwissHashMap* collection;
+  size_type index;
+
+public:
+  explicit ConstIterator(SwissHashMap* coll, size_type newIndex)
+    : collection(coll), index(newIndex)
+  {}
+
+  ConstIterator() : collection(nullptr), index(0)
+  {}
+
+  ConstIterator(const ConstIterator& other) = default;
+  ConstIterator& operator=(const ConstIterator& other) = default;
+
+  ConstIterator& operator++()
+  {
+    if(index == collection->capacity)
+      throw std::out_of_range("Attempt to reach past end iterator!");
+
+    index = collection->firstFrom(index + 1);
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    ConstIterator org = *this;
+    ++(*this);
+    return org;
+  }
+
+  ConstIterator& operator--()
+  {
+    size_type i = index;
+
+    while(i > 0)
+    {
+      if(collection->ctrl[--i] >= 0)
+      {
+        index = i;
+        return *this;
+      }
+    }
+
+    throw std::out_of_range("Attempt to reach before first element!");
+  }
+
+  ConstIterator operator--(int)
+  {
+    ConstIterator org = *this;
+    --(*this);
+    return org;
+  }
+
+  reference operator*() const
+  {
+    if(index == collection->capacity)
+      throw std::out_of_range("Attempt to dereference end iterator!");
+
+    return collection->slots[index];
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator& other) const
+  {
+    return collection == other.collection && index == other.index;
+  }
+
+  bool operator!=(const ConstIterator& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, typename Hash, typename KeyEqual>
+class SwissHashMap<KeyType, ValueType, Hash, KeyEqual>::Iterator : public SwissHashMap<KeyType, ValueType, Hash, KeyEqual>::ConstIterator
+{
+public:
+  using reference = typename SwissHashMap::reference;
+  using pointer = typename SwissHashMap::value_type*;
+
+  explicit Iterator(SwissHashMap* coll, size_type newIndex)
+    : ConstIterator(coll, newIndex)
+  {}
+
+  Iterator() : ConstIterator()
+  {}
+
+  Iterator(const ConstIterator& other)
+    : ConstIterator(other)
+  {}
+
+  Iterator& operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator& operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    // ugly cast, yet reduces code duplication.
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+}
+
+#endif /* AISDI_MAPS_SWISSHASHMAP_H */
@@ -2,16 +2,24 @@
 #define AISDI_MAPS_TREEMAP_H
 
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
-#include <vector>
+#include <functional>
+
+#include "Bits.h"
+#include "NodeArena.h"
 
 namespace aisdi
 {
 
-template <typename KeyType, typename ValueType>
-class TreeMap
+  const size_t treeBuildStackSize = 64;   //pending ranges of a balanced build, at most two per level of a tree with 32-bit links
+
+template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType> >
+class TreeMap //red-black tree, guard is the end() node and holds the root as its left child
 {
 public:
   using key_type = KeyType;
@@ -20,6 +28,7 @@ public:
   using size_type = std::size_t;
   using reference = value_type&;
   using const_reference = const value_type&;
+  using key_compare = Compare;
 
   class ConstIterator;
   class Iterator;
@@ -27,452 +36,698 @@ public:
   using const_iterator = ConstIterator;
 
 private:
+  using link = std::uint32_t;     //index of a node in the arena
+  static constexpr link nil = 0;
+
   typedef struct node
   {
     value_type value;
-    node* left;
-    node* right;
-    node* parent;
+    link left;
+    link right;
+    link parent;
+    bool red;
 
     node(): value(key_type(), mapped_type())
     {
-      left = nullptr;
-      right = nullptr;
-      parent = nullptr;
+      left = nil;
+      right = nil;
+      parent = nil;
+      red = false;
     }
 
     node(key_type key, mapped_type map): value(key,map)
     {
-      left = nullptr;
-      right = nullptr;
-      parent = nullptr;
+      left = nil;
+      right = nil;
+      parent = nil;
+      red = true;
     }
   }node;
 
-  node* root;
-  node* guard;
+  NodeArena<node> nodes;    //every node of the tree, guard included, freed slots are reused
+  link root;
+  link guard;
   size_type size;
+  key_compare comp;
 
   friend class ConstIterator;
   friend class Iterator;
 
-  void destroy(node*& current) //delete nodes from tree
+  void destroy() //runs the value destructors if there are any, then hands the chunks back
   {
-    if(current != nullptr)
+    if(!std::is_trivially_destructible<value_type>::value && guard != nil)
     {
-      destroy(current->left);
-      destroy(current->right);
-      delete current;
-      current = nullptr;
+      //only values are destroyed, the links stay readable for the walk
+      for(link current = root == nil ? guard : minVal(root); current != guard; current = following(current))
+      {
+        nodes[current].value.~value_type();
+      }
+      nodes[guard].value.~value_type();
     }
+
+    nodes.release();
+    root = nil;
+    guard = nil;
+    size = 0;
   }
 
-  node* lookFor(node* current, const key_type& key) const //look for node with given key in tree, if not found returns nullptr
+  template <typename K>
+  link lookFor(link current, const K& key) const //look for node with given key in tree, if not found returns nil
   {
-    if(current == nullptr || current->value.first == key)
+    link candidate = nil;    //lowest node not less than key, one comparison per level
+
+    while(current != nil)
     {
-      return current;
+      const node& visited = nodes[current];
+
+      if(comp(visited.value.first, key))
+      {
+        current = visited.right;
+      }
+      else
+      {
+        candidate = current;
+        current = visited.left;
+      }
     }
-    else if(current->value.first < key)
+
+    if(candidate != nil && comp(key, nodes[candidate].value.first))
+      return nil;
+
+    return candidate;
+  }
+
+  link following(link current) const //in-order successor, guard after the last node, nil after guard
+  {
+    if(nodes[current].right != nil)
+      return minVal(nodes[current].right);
+
+    link parent = nodes[current].parent;
+    while(parent != nil && current == nodes[parent].right)
     {
-      return lookFor(current->right, key);
+      current = parent;
+      parent = nodes[parent].parent;
+    }
+
+    return parent;
+  }
+
+  link preceding(link current) const //in-order predecessor, nil before the first node
+  {
+    if(nodes[current].left != nil)
+      return maxVal(nodes[current].left);
+
+    link parent = nodes[current].parent;
+    while(parent != nil && current == nodes[parent].left)
+    {
+      current = parent;
+      parent = nodes[parent].parent;
+    }
+
+    return parent;
+  }
+
+  bool isRed(link current) const //missing children count as black
+  {
+    return current != nil && nodes[current].red;
+  }
+
+  void replaceChild(link parent, link oldChild, link newChild) //parent is guard when oldChild is the root
+  {
+    if(parent == guard)
+    {
+      root = newChild;
+      nodes[guard].left = newChild;
+    }
+    else if(nodes[parent].left == oldChild)
+    {
+      nodes[parent].left = newChild;
     }
     else
     {
-      return lookFor(current->left, key);
+      nodes[parent].right = newChild;
     }
+
+    if(newChild != nil)
+      nodes[newChild].parent = parent;
+  }
+
+  void rotateLeft(link current) //current's right child takes its place
+  {
+    link child = nodes[current].right;
+
+    nodes[current].right = nodes[child].left;
+    if(nodes[child].left != nil)
+      nodes[nodes[child].left].parent = current;
+
+    replaceChild(nodes[current].parent, current, child);
+    nodes[child].left = current;
+    nodes[current].parent = child;
+  }
+
+  void rotateRight(link current) //current's left child takes its place
+  {
+    link child = nodes[current].left;
+
+    nodes[current].left = nodes[child].right;
+    if(nodes[child].right != nil)
+      nodes[nodes[child].right].parent = current;
+
+    replaceChild(nodes[current].parent, current, child);
+    nodes[child].right = current;
+    nodes[current].parent = child;
   }
 
-  void remove(node*& current, key_type number) //remove node with given key from tree
+  link insert(link newNode) //links newNode in and rebalances, returns the node already holding its key instead if there is one
   {
-    if(current != nullptr)
+    link parent = guard;
+    link current = root;
+    bool toLeft = true;
+    const key_type& key = nodes[newNode].value.first;
+
+    while(current != nil)
+    {
+      parent = current;
+
+      if(comp(key, nodes[current].value.first))
+      {
+        toLeft = true;
+        current = nodes[current].left;
+      }
+      else if(comp(nodes[current].value.first, key))
+      {
+        toLeft = false;
+        current = nodes[current].right;
+      }
+      else
+      {
+        return current;
+      }
+    }
+
+    nodes[newNode].parent = parent;
+    nodes[newNode].red = true;
+    if(parent == guard)
+    {
+      root = newNode;
+      nodes[guard].left = newNode;
+    }
+    else if(toLeft)
     {
-        if(current->value.first == number) //found correct node
+      nodes[parent].left = newNode;
+    }
+    else
+    {
+      nodes[parent].right = newNode;
+    }
+
+    size++;
+    repairInsert(newNode);
+    return newNode;
+  }
+
+  void repairInsert(link current) //restores the red-black rules after current was linked in red
+  {
+    while(current != root && isRed(nodes[current].parent))
+    {
+      link parent = nodes[current].parent;
+      link grandparent = nodes[parent].parent;   //a red parent is never the root, so this is a real node
+
+      if(parent == nodes[grandparent].left)
+      {
+        link uncle = nodes[grandparent].right;
+
+        if(isRed(uncle))
+        {
+          nodes[parent].red = false;
+          nodes[uncle].red = false;
+          nodes[grandparent].red = true;
+          current = grandparent;
+        }
+        else
         {
-            if(current->left == nullptr && current->right == nullptr) //current node is a leaf
-            {
-                if(current == root)
-                {
-                  guard->left = nullptr;
-                }
-                delete current;
-                current = nullptr;
-            }
-            else if(current->left == nullptr)
-            {
-                if(current == root)
-                {
-                  guard->left = current->right;
-                  current->right->parent = guard;
-                }
-                node* tmp = current;
-                current = current->right;
-                delete tmp;
-            }
-            else if(current->right == nullptr)
-            {
-                if(current == root)
-                {
-                  guard->left = current->left;
-                  current->left->parent = guard;
-                }
-                node* tmp = current;
-                current = current->left;
-                delete tmp;
-            }
-            else
-            {
-                node* tmp = current;
-                tmp = tmp->right;
-                node* prevtmp = nullptr;
-
-                while(tmp->left != nullptr)
-                {
-                    prevtmp = tmp;
-                    tmp = tmp->left;
-                }
-
-                if(prevtmp != nullptr)
-                {
-                    prevtmp->left = tmp->right;
-                }
-
-                tmp->left = current->left;
-
-                if(current->right != tmp)
-                {
-                    tmp->right = current->right;
-                }
-                if(current == root)
-                {
-                  guard->right = tmp;
-                  tmp->parent = guard;
-                }
-                delete current;
-                current = tmp;
-
-            }
+          if(current == nodes[parent].right)
+          {
+            rotateLeft(parent);
+            current = parent;
+            parent = nodes[current].parent;
+          }
+
+          nodes[parent].red = false;
+          nodes[grandparent].red = true;
+          rotateRight(grandparent);
         }
-        else if(current->value.first > number)
+      }
+      else
+      {
+        link uncle = nodes[grandparent].left;
+
+        if(isRed(uncle))
         {
-            if(current->left != nullptr)
-            {
-                if(current->left->value.first == number)
-                {
-                    node* tmp = current;
-                    if(tmp->left->left == nullptr && tmp->left->right == nullptr)
-                    {
-                        delete tmp->left;
-                        tmp->left = nullptr;
-                    }
-                    else if(tmp->left->left == nullptr)
-                    {
-                        node* tmp2 = tmp->left->right;
-                        delete tmp->left;
-                        tmp->left = tmp2;
-                    }
-                    else if(tmp->left->right == nullptr)
-                    {
-                        node* tmp2 = tmp->left->left;
-                        delete tmp->left;
-                        tmp->left = tmp2;
-                    }
-                    else
-                    {
-                        node* last = tmp->left->right;
-                        node* prevlast = nullptr;
-                        while(last->left != nullptr)
-                        {
-                            prevlast = last;
-                            last = last->left;
-                        }
-
-                        if(prevlast != nullptr)
-                        {
-                            prevlast->left = last->right;
-                        }
-
-                        last->left = tmp->left->left;
-
-                        if(tmp->left->right != last)
-                        {
-                            last->right = tmp->left->right;
-                        }
-                        delete tmp->left;
-                        tmp->left = last;
-                    }
-                }
-                else if(current->left->value.first > number)
-                {
-                    node* tmp = current;
-                    tmp = tmp->left;
-                    remove(tmp,number);
-                }
-                else
-                {
-                    node* tmp = current;
-                    tmp = tmp->left;
-                    remove(tmp,number);
-                }
-            }
+          nodes[parent].red = false;
+          nodes[uncle].red = false;
+          nodes[grandparent].red = true;
+          current = grandparent;
         }
-        else if(current->value.first < number)
+        else
         {
-            if(current->right != nullptr)
-            {
-                if(current->right->value.first == number)
-                {
-                    node* tmp = current;
-                    if(tmp->right->left == nullptr && tmp->right->right == nullptr)
-                    {
-                        delete tmp->right;
-                        tmp->right = nullptr;
-                    }
-                    else if(tmp->right->left == nullptr)
-                    {
-                        node* tmp2 = tmp->right->right;
-                        delete tmp->right;
-                        tmp->right = tmp2;
-                    }
-                    else if(tmp->right->right == nullptr)
-                    {
-                        node* tmp2 = tmp->right->left;
-                        delete tmp->right;
-                        tmp->right = tmp2;
-                    }
-                    else
-                    {
-                        node* last = tmp->right->right;
-                        node* prevlast = nullptr;
-                        while(last->left != nullptr)
-                        {
-                            prevlast = last;
-                            last = last->left;
-                        }
-
-                        if(prevlast != nullptr)
-                        {
-                            prevlast->left = last->right;
-                        }
-
-                        last->left = tmp->right->left;
-
-                        if(tmp->right->right != last)
-                        {
-                            last->right = tmp->right->right;
-                        }
-                        delete tmp->right;
-                        tmp->right = last;
-                    }
-                }
-                else if(current->right->value.first > number)
-                {
-                    node* tmp = current;
-                    tmp = tmp->right;
-                    remove(tmp,number);
-                }
-                else
-                {
-                    node* tmp = current;
-                    tmp = tmp->right;
-                    remove(tmp,number);
-                }
-            }
+          if(current == nodes[parent].left)
+          {
+            rotateRight(parent);
+            current = parent;
+            parent = nodes[current].parent;
+          }
+
+          nodes[parent].red = false;
+          nodes[grandparent].red = true;
+          rotateLeft(grandparent);
         }
+      }
     }
+
+    nodes[root].red = false;
   }
 
-  bool checkDiff(node* first, node* second) const //check trees for differences
+  void erase(link target) //unlinks target and frees its slot, nodes are relinked rather than copied so other iterators stay valid
   {
-    bool foundDiff = false;
-    if(first != nullptr && second != nullptr)
+    link replacement;          //the node moving into the removed black node's position, may be nil
+    link replacementParent;
+    bool removedRed = nodes[target].red;
+
+    if(nodes[target].left == nil)
     {
-      foundDiff = (first->value.first != second->value.first || first->value.second != second->value.second)
-                  || checkDiff(first->left,second->left)
-                  || checkDiff(first->right,second->right);
+      replacement = nodes[target].right;
+      replacementParent = nodes[target].parent;
+      replaceChild(nodes[target].parent, target, nodes[target].right);
     }
-    else if((first == nullptr && second != nullptr) || (first != nullptr && second == nullptr))
+    else if(nodes[target].right == nil)
     {
-      foundDiff = true;
+      replacement = nodes[target].left;
+      replacementParent = nodes[target].parent;
+      replaceChild(nodes[target].parent, target, nodes[target].left);
     }
-    return foundDiff;
-  }
-
-  void insert(node*& current,node* newNode) //inserts node into a tree
-  {
-    if(current == nullptr)
+    else
     {
-      current = newNode;
-      if(size == 0)
+      link next = minVal(nodes[target].right);
+
+      removedRed = nodes[next].red;
+      replacement = nodes[next].right;
+
+      if(nodes[next].parent == target)
       {
-        current->parent = guard;
-        guard->left = current;
+        replacementParent = next;
       }
-      size++;
+      else
+      {
+        replacementParent = nodes[next].parent;
+        replaceChild(nodes[next].parent, next, nodes[next].right);
+        nodes[next].right = nodes[target].right;
+        nodes[nodes[next].right].parent = next;
+      }
+
+      replaceChild(nodes[target].parent, target, next);
+      nodes[next].left = nodes[target].left;
+      nodes[nodes[next].left].parent = next;
+      nodes[next].red = nodes[target].red;
     }
-    else
+
+    nodes.destroy(target);
+    size--;
+
+    if(!removedRed)
+      repairErase(replacement, replacementParent);
+  }
+
+  void repairErase(link current, link parent) //current carries an extra black, parent is needed as current may be nil
+  {
+    while(current != root && !isRed(current))
     {
-      if(current->value.first > newNode->value.first)
+      if(current == nodes[parent].left)
       {
-        if(current->left == nullptr)
+        link sibling = nodes[parent].right;   //non-nil, its side has the black node that was removed from this one
+
+        if(isRed(sibling))
         {
-          current->left = newNode;
-          newNode->parent = current;
-          size++;
+          nodes[sibling].red = false;
+          nodes[parent].red = true;
+          rotateLeft(parent);
+          sibling = nodes[parent].right;
+        }
+
+        if(!isRed(nodes[sibling].left) && !isRed(nodes[sibling].right))
+        {
+          nodes[sibling].red = true;
+          current = parent;
+          parent = nodes[current].parent;
         }
         else
         {
-          node* tmp = current->left;
-          insert(tmp,newNode);
+          if(!isRed(nodes[sibling].right))
+          {
+            nodes[nodes[sibling].left].red = false;
+            nodes[sibling].red = true;
+            rotateRight(sibling);
+            sibling = nodes[parent].right;
+          }
+
+          nodes[sibling].red = nodes[parent].red;
+          nodes[parent].red = false;
+          nodes[nodes[sibling].right].red = false;
+          rotateLeft(parent);
+          current = root;
         }
       }
-      else if(current->value.first < newNode->value.first)
+      else
       {
-        if(current->right == nullptr)
+        link sibling = nodes[parent].left;
+
+        if(isRed(sibling))
+        {
+          nodes[sibling].red = false;
+          nodes[parent].red = true;
+          rotateRight(parent);
+          sibling = nodes[parent].left;
+        }
+
+        if(!isRed(nodes[sibling].left) && !isRed(nodes[sibling].right))
         {
-          current->right = newNode;
-          newNode->parent = current;
-          size++;
+          nodes[sibling].red = true;
+          current = parent;
+          parent = nodes[current].parent;
         }
         else
         {
-          node* tmp = current;
-          tmp = tmp->right;
-          insert(tmp,newNode);
+          if(!isRed(nodes[sibling].left))
+          {
+            nodes[nodes[sibling].right].red = false;
+            nodes[sibling].red = true;
+            rotateLeft(sibling);
+            sibling = nodes[parent].left;
+          }
+
+          nodes[sibling].red = nodes[parent].red;
+          nodes[parent].red = false;
+          nodes[nodes[sibling].left].red = false;
+          rotateRight(parent);
+          current = root;
         }
       }
     }
+
+    if(current != nil)
+      nodes[current].red = false;
+  }
+
+  link cloneNode(const node& source) //unlinked copy of source's entry and colour
+  {
+    link created = nodes.create(source.value.first,source.value.second);
+    nodes[created].red = source.red;
+    return created;
   }
 
-  void copy(node*& current,node* other, node* prev) //copies other tree to current tree
+  void copy(const TreeMap& other) //copies other tree under guard, walking both trees through parent links
   {
-    if(other != nullptr)
+    if(other.root == nil)
+      return;
+
+    link source = other.root;
+    link target = cloneNode(other.nodes[source]);
+    replaceChild(guard, nil, target);
+    size = 1;
+
+    while(true)
     {
-      current = new node(other->value.first,other->value.second);
-      current->parent = prev;
-      if(size == 0)
+      link next = nil;
+
+      if(other.nodes[source].left != nil && nodes[target].left == nil)
+      {
+        source = other.nodes[source].left;
+        next = cloneNode(other.nodes[source]);
+        nodes[target].left = next;
+      }
+      else if(other.nodes[source].right != nil && nodes[target].right == nil)
+      {
+        source = other.nodes[source].right;
+        next = cloneNode(other.nodes[source]);
+        nodes[target].right = next;
+      }
+      else if(source == other.root)
+      {
+        break;
+      }
+      else
       {
-        guard->left = current;
+        source = other.nodes[source].parent;
+        target = nodes[target].parent;
+        continue;
       }
 
+      nodes[next].parent = target;
+      target = next;
       size++;
-      copy(current->left,other->left,current);
-      copy(current->right,other->right,current);
     }
   }
 
-  node* minVal(node* current) const //returns node with minimal key
+  template <typename ForwardIt>
+  bool countAscending(ForwardIt first, ForwardIt last, size_type& count) const //false if a key is below the one before it, count gets the distinct keys
   {
-    if(current->left == nullptr)
+    count = 0;
+    if(first == last)
+      return true;
+
+    count = 1;
+    for(ForwardIt previous = first++; first != last; previous = first++)
+    {
+      if(comp(first->first, previous->first))
+        return false;
+
+      if(comp(previous->first, first->first))
+        count++;
+    }
+
+    return true;
+  }
+
+  template <typename ForwardIt>
+  void buildSorted(ForwardIt first, ForwardIt last, size_type count) //empty tree only, count distinct ascending keys become a midpoint tree
+  {
+    if(count == 0)
+      return;
+
+    //the nodes are created in key order from an arena without freed slots, so the i-th key lives at base + i
+    nodes.reserve(count);
+    link base = nil;
+    for(ForwardIt previous = last; first != last; previous = first++)
+    {
+      if(previous != last && !comp(previous->first, first->first))
+        continue;     //equal to the key before, the first one is kept
+
+      link created = nodes.create(first->first,first->second);
+      if(base == nil)
+        base = created;
+    }
+
+    //the levels above the lowest one are full, making the lowest red gives every path the same number of black nodes
+    size_type redDepth = 63 - countLeadingZeros(std::uint64_t(count));
+
+    struct Range
+    {
+      size_type begin;
+      size_type end;
+      link parent;
+      size_type depth;
+    };
+
+    Range pending[treeBuildStackSize];
+    size_type top = 0;
+    pending[top++] = {0, count, guard, 0};
+
+    while(top > 0)
+    {
+      Range range = pending[--top];
+      size_type middle = range.begin + (range.end - range.begin) / 2;
+      link current = static_cast<link>(base + middle);
+      node& visited = nodes[current];
+
+      visited.parent = range.parent;
+      visited.red = range.depth > 0 && range.depth == redDepth;
+      visited.left = nil;
+      visited.right = nil;
+
+      if(middle + 1 < range.end)
+      {
+        visited.right = static_cast<link>(base + middle + 1 + (range.end - middle - 1) / 2);
+        pending[top++] = {middle + 1, range.end, current, range.depth + 1};
+      }
+
+      if(range.begin < middle)
+      {
+        visited.left = static_cast<link>(base + range.begin + (middle - range.begin) / 2);
+        pending[top++] = {range.begin, middle, current, range.depth + 1};
+      }
+    }
+
+    root = static_cast<link>(base + count / 2);
+    nodes[guard].left = root;
+    size = count;
+  }
+
+  link appendLast(link last, link newNode) //links newNode as the right child of last, the maximum or guard when empty
+  {
+    nodes[newNode].parent = last;
+    if(last == guard)
     {
-      return current;
+      root = newNode;
+      nodes[guard].left = newNode;
     }
     else
     {
-      return minVal(current->left);
+      nodes[last].right = newNode;
     }
+
+    size++;
+    repairInsert(newNode);
+    return newNode;
   }
 
-  void addToVector(std::vector<value_type>& vec, node* current) const //add values from tree to vector (pre-order)
+  template <typename InputIt>
+  void load(InputIt first, InputIt last, bool requireSorted) //empty tree only, sorted input never searches the tree
   {
-    if(current != nullptr)
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+    if constexpr(std::is_base_of<std::forward_iterator_tag, category>::value)
     {
-      addToVector(vec, current->left);
-      vec.push_back(current->value);
-      addToVector(vec, current->right);
+      size_type count;
+
+      if(countAscending(first, last, count))
+      {
+        buildSorted(first, last, count);
+        return;
+      }
+    }
+
+    //single pass input, or unsorted: keys above the maximum are appended, the rest inserted
+    link maximum = guard;
+    for(; first != last; ++first)
+    {
+      if(maximum == guard || comp(nodes[maximum].value.first, first->first))
+      {
+        maximum = appendLast(maximum, nodes.create(first->first,first->second));
+      }
+      else if(requireSorted && comp(first->first, nodes[maximum].value.first))
+      {
+        throw std::invalid_argument("Keys are not in ascending order!");
+      }
+      else
+      {
+        link newNode = nodes.create(first->first,first->second);
+        if(insert(newNode) != newNode)
+          nodes.destroy(newNode);
+      }
     }
   }
 
-  bool areEqiuvalent(node* first, node*second) const
+  link minVal(link current) const //returns node with minimal key
   {
-    std::vector<value_type > firstVec;
-    std::vector<value_type > secondVec;
+    while(nodes[current].left != nil)
+    {
+      current = nodes[current].left;
+    }
+
+    return current;
+  }
 
-    addToVector(firstVec,first);
-    addToVector(secondVec,second);
+  link maxVal(link current) const //returns node with maximal key
+  {
+    while(nodes[current].right != nil)
+    {
+      current = nodes[current].right;
+    }
 
-    return firstVec == secondVec;
+    return current;
   }
 
 public:
   TreeMap()
   {
-      guard = new node();
-      root = nullptr;
+      guard = nodes.create();
+      root = nil;
       size = 0;
   }
 
   TreeMap(std::initializer_list<value_type> list)
+    : TreeMap(list.begin(), list.end())
+  {}
+
+  template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+  TreeMap(InputIt first, InputIt last) //sorted input is built in O(n), of equal keys the first is kept
+    : TreeMap()
   {
-    guard = new node();
-    root = nullptr;
-    size = 0;
-    node* newNode;
-    for(auto it = list.begin(); it < list.end(); ++it)
-    {
-      newNode = new node(it->first,it->second);
-      insert(root,newNode);
-    }
+    load(first, last, false);
+  }
+
+  template <typename InputIt>
+  static TreeMap fromSorted(InputIt first, InputIt last) //O(n), throws std::invalid_argument if a key is below the one before it
+  {
+    TreeMap map;
+    map.load(first, last, true);
+    return map;
   }
 
-  TreeMap(const TreeMap& other)
+  TreeMap(const TreeMap& other) : comp(other.comp)
   {
 
-    root = nullptr;
+    root = nil;
     size = 0;
 
-    guard = new node();
-    copy(root,other.root,guard);
+    guard = nodes.create();
+    copy(other);
   }
 
-  TreeMap(TreeMap&& other) noexcept
+  TreeMap(TreeMap&& other) noexcept : nodes(std::move(other.nodes)), comp(other.comp)
   {
     guard = other.guard;
     root = other.root;
     size = other.size;
 
-    other.guard = nullptr;
-    other.root = nullptr;
+    other.guard = nil;
+    other.root = nil;
     other.size = 0;
   }
 
   ~TreeMap()
   {
-    destroy(root);
-    delete guard;
-    guard = nullptr;
-    size = 0;
-
+    destroy();
   }
 
   TreeMap& operator=(const TreeMap& other)
   {
-    if(*this == other)
+    if(this == &other)
       return *this;
 
-    destroy(root);
-    delete guard;
-    size = 0;
-    guard = new node();
-    copy(root,other.root,guard);
+    destroy();
+    comp = other.comp;
+    guard = nodes.create();
+    copy(other);
 
     return *this;
   }
 
   TreeMap& operator=(TreeMap&& other) noexcept
   {
-    if(*this == other)
+    if(this == &other)
       return *this;
 
-    destroy(root);
-    delete guard;
+    destroy();
 
+    nodes = std::move(other.nodes);
     root = other.root;
     guard = other.guard;
     size = other.size;
+    comp = other.comp;
 
-    other.root = nullptr;
-    other.guard = nullptr;
+    other.root = nil;
+    other.guard = nil;
     other.size = 0;
 
     return *this;
@@ -485,15 +740,15 @@ public:
 
   mapped_type& operator[](const key_type& key)
   {
-    node* target = lookFor(root,key);
+    link target = lookFor(root,key);
 
-    if(target == nullptr)
+    if(target == nil)
     {
-      target = new node(key,mapped_type());
-      insert(root,target);
+      target = nodes.create(key,mapped_type());
+      insert(target);
     }
 
-    return target->value.second;
+    return nodes[target].value.second;
   }
 
   const mapped_type& valueOf(const key_type& key) const
@@ -508,10 +763,24 @@ public:
     return it->second;
   }
 
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  const mapped_type& valueOf(const K& key) const
+  {
+    ConstIterator it = find(key);
+    return it->second;
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  mapped_type& valueOf(const K& key)
+  {
+    Iterator it = find(key);
+    return it->second;
+  }
+
   const_iterator find(const key_type& key) const
   {
-    node* target = lookFor(root,key);
-    if(target == nullptr) target = guard;
+    link target = lookFor(root,key);
+    if(target == nil) target = guard;
 
     ConstIterator it = ConstIterator(const_cast<TreeMap *>(this), target);
     return it;
@@ -519,26 +788,56 @@ public:
 
   iterator find(const key_type& key)
   {
-    node* target = lookFor(root,key);
-    if(target == nullptr) target = guard;
+    link target = lookFor(root,key);
+    if(target == nil) target = guard;
 
     Iterator it = Iterator(this,target);
     return it;
   }
 
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  const_iterator find(const K& key) const //lookup by any type the comparator accepts, no key_type is built
+  {
+    link target = lookFor(root,key);
+    if(target == nil) target = guard;
+
+    return ConstIterator(const_cast<TreeMap *>(this), target);
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  iterator find(const K& key)
+  {
+    link target = lookFor(root,key);
+    if(target == nil) target = guard;
+
+    return Iterator(this,target);
+  }
+
   void remove(const key_type& key)
   {
-    if(lookFor(root,key) == nullptr)
+    link target = lookFor(root,key);
+    if(target == nil)
       throw std::out_of_range("Element not in collection. Cannot remove.");
 
-    remove(root,key);
-    size--;
+    erase(target);
+  }
+
+  template <typename K, typename C = key_compare, typename = typename C::is_transparent>
+  void remove(const K& key)
+  {
+    link target = lookFor(root,key);
+    if(target == nil)
+      throw std::out_of_range("Element not in collection. Cannot remove.");
+
+    erase(target);
   }
 
   void remove(const const_iterator& it)
   {
-    remove(root,it->first);
-    size--;
+    if(it.selectedNode == guard)
+      throw std::out_of_range("Attempt to remove end iterator!");
+
+    erase(it.selectedNode);
   }
 
   size_type getSize() const
@@ -551,15 +850,21 @@ public:
     if(size != other.size)
       return false;
 
-    node* tmp = root;
-    node* tmpOther = other.root;
+    if(size == 0)
+      return true;
+
+    //same size, so equal maps hold the same entries in the same in-order positions whatever their shapes;
+    //keys match when neither orders before the other, the comparator may not agree with key_type's operator==
+    for(link tmp = minVal(root), tmpOther = other.minVal(other.root); tmp != guard; tmp = following(tmp), tmpOther = other.following(tmpOther))
+    {
+      const value_type& value = nodes[tmp].value;
+      const value_type& valueOther = other.nodes[tmpOther].value;
 
-    bool foundDifference = checkDiff(tmp,tmpOther);
+      if(comp(value.first, valueOther.first) || comp(valueOther.first, value.first) || value.second != valueOther.second)
+        return false;
+    }
 
-    if(!foundDifference)
-      return true;
-    else
-      return areEqiuvalent(tmp,tmpOther);
+    return true;
   }
 
   bool operator!=(const TreeMap& other) const
@@ -614,8 +919,8 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class TreeMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Compare>
+class TreeMap<KeyType, ValueType, Compare>::ConstIterator
 {
 public:
   using reference = typename TreeMap::const_reference;
@@ -625,62 +930,16 @@ public:
 
 protected:
   TreeMap* collection;
-  node* selectedNode;
+  link selectedNode;
 
   friend class TreeMap;
 
-  node* successor()
-  {
-    node* tmp = nullptr;
-    if(selectedNode->right != nullptr)
-    {
-      tmp = selectedNode->right;
-      while(tmp->left != nullptr)
-      {
-        tmp = tmp->left;
-      }
-    }
-    else
-    {
-      tmp = selectedNode->parent;
-      while(tmp != nullptr && selectedNode == tmp->right)
-      {
-        selectedNode = tmp;
-        tmp = tmp->parent;
-      }
-    }
-    return tmp;
-  }
-
-  node* predecessor()
-  {
-    node* tmp = nullptr;
-    if(selectedNode->left != nullptr)
-    {
-      tmp = selectedNode->left;
-      while(tmp->left != nullptr)
-      {
-        tmp = tmp->left;
-      }
-    }
-    else
-    {
-      tmp = selectedNode->parent;
-      while(tmp != nullptr && selectedNode == tmp->left)
-      {
-        selectedNode = tmp;
-        tmp = tmp->parent;
-      }
-    }
-    return tmp;
-  }
-
 public:
 
-  ConstIterator(): collection(nullptr), selectedNode(nullptr)
+  ConstIterator(): collection(nullptr), selectedNode(nil)
   {}
 
-  explicit ConstIterator(TreeMap* tree,node* newNode)
+  explicit ConstIterator(TreeMap* tree,link newNode)
   {
     collection = tree;
     selectedNode = newNode;
@@ -694,9 +953,9 @@ public:
 
   ConstIterator& operator++()
   {
-    node* tmp = successor();
+    link tmp = collection->following(selectedNode);
 
-    if(tmp == nullptr)
+    if(tmp == nil)
       throw std::out_of_range("Attempt to reach past last element!");
 
     selectedNode = tmp;
@@ -713,9 +972,9 @@ public:
 
   ConstIterator& operator--()
   {
-    node* tmp = predecessor();
+    link tmp = collection->preceding(selectedNode);
 
-    if(tmp == nullptr)
+    if(tmp == nil)
       throw std::out_of_range("Attempt to reach before first element!");
 
     selectedNode = tmp;
@@ -735,7 +994,7 @@ public:
     if(*this == collection->end())
       throw std::out_of_range("Attempt to dereference end iterator!");
 
-    return selectedNode->value;
+    return collection->nodes[selectedNode].value;
   }
 
   pointer operator->() const
@@ -757,8 +1016,8 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class TreeMap<KeyType, ValueType>::Iterator : public TreeMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Compare>
+class TreeMap<KeyType, ValueType, Compare>::Iterator : public TreeMap<KeyType, ValueType, Compare>::ConstIterator
 {
 public:
   using reference = typename TreeMap::reference;
@@ -771,7 +1030,7 @@ public:
   explicit Iterator(): ConstIterator()
   {}
 
-  Iterator(TreeMap* tree, node* current): ConstIterator(tree, current)
+  Iterator(TreeMap* tree, link current): ConstIterator(tree, current)
   {}
 
   Iterator(const ConstIterator& other)
@@ -5,9 +5,27 @@
 #include <random>
 #include <ctime>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
 
 #include "TreeMap.h"
+#include "BTreeMap.h"
 #include "HashMap.h"
+#include "RobinHoodHashMap.h"
+#include "SwissHashMap.h"
+#include "CuckooHashMap.h"
+#include "PoolAllocator.h"
+#include "ConcurrentHashMap.h"
+#include "ReadMostlyHashMap.h"
+#include "HashMapSnapshot.h"
+#include "FrozenHashMap.h"
 
 namespace
 {
@@ -16,7 +34,21 @@ namespace
   template <typename K, typename V>
   using HashMap = aisdi::HashMap<K, V>;
   template <typename K, typename V>
+  using PooledHashMap = aisdi::HashMap<K, V, aisdi::DefaultHash<K>, std::equal_to<K>, aisdi::PoolAllocator<std::pair<K, V> > >;
+  template <typename K, typename V>
   using TreeMap = aisdi::TreeMap<K,V>;
+  template <typename K, typename V>
+  using BTreeMap = aisdi::BTreeMap<K,V>;
+  template <typename K, typename V>
+  using RobinHoodHashMap = aisdi::RobinHoodHashMap<K, V>;
+  template <typename K, typename V>
+  using SwissHashMap = aisdi::SwissHashMap<K, V>;
+  template <typename K, typename V>
+  using CuckooHashMap = aisdi::CuckooHashMap<K, V>;
+  template <typename K, typename V>
+  using ConcurrentHashMap = aisdi::ConcurrentHashMap<K, V>;
+  template <typename K, typename V>
+  using ReadMostlyHashMap = aisdi::ReadMostlyHashMap<K, V>;
   using time_type = std::chrono::time_point<std::chrono::system_clock>;
   using duration_type = std::chrono::duration<double>;
 
@@ -63,27 +95,169 @@ namespace
 
     //removing
     start = std::chrono::system_clock::now();
-    for(auto it = collection.begin(); it != collection.end(); ++it)
+    auto it = collection.begin();
+    while(it != collection.end())
     {
-      collection.remove(it);
+      collection.remove(it++);
     }
     end = std::chrono::system_clock::now();
     timeElapsed = end - start;
     std::cout << "Removing " << size << " elements takes: " << timeElapsed.count() << "s" << std::endl;
 
+
+    //sorted keys, the worst case for an unbalanced tree
+    for(bool reversed : {false, true})
+    {
+      TreeMap<size_t,std::string> ordered;
+      const char* order = reversed ? "reversed" : "sequential";
+
+      start = std::chrono::system_clock::now();
+      for(size_t i = 0; i < n; i++)
+      {
+        ordered[reversed ? n - 1 - i : i] = "Funny element name";
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Adding " << n << " elements in " << order << " order takes: " << timeElapsed.count() << "s" << std::endl;
+
+      start = std::chrono::system_clock::now();
+      for(size_t i = 0; i < n; i++)
+      {
+        ordered.find(i);
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Searching for " << n << " elements added in " << order << " order takes: " << timeElapsed.count() << "s" << std::endl;
+    }
+
+
+    //bulk construction, sorted input is linked into a balanced tree without a single search
+    {
+      std::vector<std::pair<size_t,std::string>> sorted;
+      for(size_t i = 0; i < n; i++)
+      {
+        sorted.emplace_back(i, "Funny element name");
+      }
+
+      start = std::chrono::system_clock::now();
+      auto built = TreeMap<size_t,std::string>::fromSorted(sorted.cbegin(), sorted.cend());
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Building a map from " << built.getSize() << " sorted elements takes: " << timeElapsed.count() << "s" << std::endl;
+    }
+
+
+    //destroying, trivially destructible entries let the whole arena go at once
+    {
+      auto numbers = new TreeMap<size_t,size_t>();
+      for(size_t i = 0; i < n; i++)
+      {
+        (*numbers)[i] = i;
+      }
+
+      start = std::chrono::system_clock::now();
+      delete numbers;
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Destroying a map of " << n << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+    }
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+  }
+
+  template <typename Map>
+  size_t timeOrderedMap(Map& collection, const std::vector<size_t>& keys, const std::vector<size_t>& lookups, const std::string& name) //returns a checksum of the in-order scan
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+
+    start = std::chrono::system_clock::now();
+    for(size_t key : keys)
+    {
+      collection[key] = key;
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Adding " << keys.size() << " random elements to " << name << " takes: " << timeElapsed.count() << "s" << std::endl;
+
+    size_t found = 0;
+    start = std::chrono::system_clock::now();
+    for(size_t key : lookups)
+    {
+      found += collection.valueOf(key) == key;
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << lookups.size() << " elements in " << name << " takes: " << timeElapsed.count() << "s" << std::endl;
+
+    size_t checksum = 0;
+    start = std::chrono::system_clock::now();
+    for(auto it = collection.cbegin(); it != collection.cend(); ++it)
+    {
+      checksum = checksum * 31 + it->first;
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Scanning " << collection.getSize() << " elements of " << name << " in order takes: " << timeElapsed.count() << "s" << std::endl;
+
+    return found == lookups.size() ? checksum : 0;
+  }
+
+  bool performBTreeMapTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    std::mt19937_64 generator(n);
+    std::vector<size_t> keys(n);
+
+    std::cout << "BTreeMap tests: " << std::endl;
     std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    //an odd multiplier is a bijection, so the keys are distinct yet spread over the whole range
+    for(size_t i = 0; i < n; i++)
+    {
+      keys[i] = i * 0x9e3779b97f4a7c15ull;
+    }
+    std::shuffle(keys.begin(), keys.end(), generator);
+    std::vector<size_t> lookups(keys);
+    std::shuffle(lookups.begin(), lookups.end(), generator);
+
+    TreeMap<size_t, size_t> tree;
+    BTreeMap<size_t, size_t> bTree;
+    size_t treeChecksum = timeOrderedMap(tree, keys, lookups, "TreeMap");
+    size_t bTreeChecksum = timeOrderedMap(bTree, keys, lookups, "BTreeMap");
+
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i += 2)
+    {
+      bTree.remove(keys[i]);
+    }
+    auto it = bTree.begin();
+    while(it != bTree.end())
+    {
+      it = bTree.remove(it);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Removing " << n << " elements from BTreeMap takes: " << timeElapsed.count() << "s" << std::endl;
+
+    bool passed = treeChecksum == bTreeChecksum && tree.getSize() == n && bTree.isEmpty();
+    std::cout << (passed ? "BTreeMap matches TreeMap" : "BTREEMAP DIFFERS FROM TREEMAP") << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
   }
 
-  void performHashMapTest(size_t n)
+  template <typename Map>
+  void performHashMapTest(size_t n, const std::string& name)
   {
     time_type start, end;
     duration_type timeElapsed;
-    HashMap<size_t,std::string> collection;
+    Map collection;
     std::default_random_engine generator;
     std::normal_distribution<double> distribution(n,n);
     size_t index;
 
-    std::cout << "HashMap tests: " << std::endl;
+    std::cout << name << " tests: " << std::endl;
     std::cout << "--------------------------------------------------------------------------------" << std::endl;
 
     start = std::chrono::system_clock::now();
@@ -110,6 +284,73 @@ namespace
     timeElapsed = end - start;
     std::cout << "Searching for " << n << " elements takes: " << timeElapsed.count() << "s" << std::endl;
 
+    auto stats = collection.bucketStats();
+    std::cout << "Load factor " << collection.load_factor() << " over " << stats.bucketCount << " buckets, longest chain "
+              << stats.longestChain << ", empty buckets " << stats.emptyRatio * 100 << "%" << std::endl;
+
+    Map presized;
+    start = std::chrono::system_clock::now();
+    presized.reserve(n);
+    for(size_t i = 0; i < n; i++)
+    {
+      presized[i] = "Another funny element name";
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Adding " << n << " elements after reserve() takes: " << timeElapsed.count() << "s" << std::endl;
+
+    //the same keys looked up one at a time and then in batches, key generation is left out of both timings
+    const size_t batchSize = 32;
+    std::vector<size_t> keys(n);
+    std::vector<size_t> batch;
+    std::vector<typename Map::const_iterator> found;
+    for(auto& key : keys)
+    {
+      key = static_cast<size_t >(distribution(generator));
+    }
+
+    size_t hits = 0;
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i++)
+    {
+      hits += collection.find(keys[i]) != collection.cend();
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << n << " pregenerated elements one by one takes: " << timeElapsed.count() << "s ("
+              << hits << " found)" << std::endl;
+
+    size_t batchHits = 0;
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i += batchSize)
+    {
+      batch.assign(keys.begin() + i, keys.begin() + std::min(n, i + batchSize));
+      found.clear();
+      batchHits += collection.findBatch(batch, std::back_inserter(found));
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << n << " pregenerated elements in batches of " << batchSize << " takes: "
+              << timeElapsed.count() << "s (" << batchHits << " found)" << std::endl;
+
+    //a reused scratch map keeps its table, clear() only pays for the few entries it holds
+    const size_t clearRounds = 1000;
+    Map scratch;
+    scratch.reserve(n);
+    start = std::chrono::system_clock::now();
+    for(size_t round = 0; round < clearRounds; round++)
+    {
+      for(size_t i = 0; i < 5; i++)
+      {
+        scratch[i] = "Another funny element name";
+      }
+      scratch.clear();
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Filling and clearing a 5 element map reserved for " << n << " elements " << clearRounds << " times takes: "
+              << timeElapsed.count() << "s" << std::endl;
+
     start = std::chrono::system_clock::now();
     auto it = collection.begin();
     while(it != collection.end())
@@ -123,10 +364,638 @@ namespace
     std::cout << "--------------------------------------------------------------------------------" << std::endl;
   }
 
-  void perfomTest(size_t n)
+  void performIncrementalRehashTest(size_t n) //the slowest single insert shows the cost of growing the table in one go
+  {
+    std::cout << "HashMap growth latency tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    for(bool incremental : {false, true})
+    {
+      HashMap<size_t, size_t> collection;
+      duration_type slowest(0), total(0);
+
+      collection.setIncrementalRehash(incremental);
+      for(size_t i = 0; i < n; i++)
+      {
+        time_type start = std::chrono::system_clock::now();
+        collection[i] = i;
+        duration_type timeElapsed = std::chrono::system_clock::now() - start;
+
+        total += timeElapsed;
+        slowest = std::max(slowest, timeElapsed);
+      }
+
+      std::cout << "Adding " << n << " elements with " << (incremental ? "incremental" : "full") << " rehashing takes: "
+                << total.count() << "s, slowest insert: " << slowest.count() * 1e6 << "us" << std::endl;
+    }
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+  }
+
+  bool performParallelScanTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    HashMap<size_t, size_t> collection;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "HashMap parallel scan tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    for(size_t i = 0; i < n; i++)
+    {
+      collection[i] = i;
+    }
+
+    size_t expected = 0;
+    start = std::chrono::system_clock::now();
+    for(auto it = collection.cbegin(); it != collection.cend(); ++it)
+    {
+      expected += it->second;
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Scanning " << n << " elements on 1 thread takes: " << timeElapsed.count() << "s" << std::endl;
+
+    bool passed = true;
+    for(size_t threads = 2; threads <= std::max<size_t>(2, maxThreads); threads *= 2)
+    {
+      //each range sums into its own slot, so the scan itself shares nothing
+      auto ranges = collection.partition(threads);
+      std::vector<size_t> sums(ranges.size(), 0);
+      std::vector<std::thread> workers;
+
+      start = std::chrono::system_clock::now();
+      for(size_t r = 0; r < ranges.size(); r++)
+      {
+        workers.emplace_back([&ranges, &sums, r]()
+        {
+          for(auto it = ranges[r].first; it != ranges[r].second; ++it)
+          {
+            sums[r] += it->second;
+          }
+        });
+      }
+      for(auto& worker : workers)
+      {
+        worker.join();
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+
+      size_t total = 0;
+      for(size_t sum : sums)
+      {
+        total += sum;
+      }
+      passed = passed && total == expected;
+      std::cout << "Scanning " << n << " elements in " << ranges.size() << " partitions takes: " << timeElapsed.count() << "s" << std::endl;
+    }
+
+    std::atomic<size_t> visited(0);
+    start = std::chrono::system_clock::now();
+    collection.parallelForEach([&visited](const std::pair<size_t, size_t>&) { visited.fetch_add(1, std::memory_order_relaxed); });
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    passed = passed && visited == n;
+    std::cout << "parallelForEach over " << n << " elements takes: " << timeElapsed.count() << "s, "
+              << (passed ? "every element visited once" : "PARTITIONS DO NOT COVER THE MAP") << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  template <typename Map>
+  void performOpenAddressingTest(size_t n, const std::string& name) //removal goes through it = remove(it), entries move on removal
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    Map collection;
+    std::default_random_engine generator;
+    std::normal_distribution<double> distribution(n,n);
+    size_t index;
+
+    std::cout << name << " tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i++)
+    {
+      index = static_cast<size_t >(distribution(generator));
+      if(collection.find(index) == collection.cend())
+      {
+        collection[index] = "Another funny element name";
+      }
+    }
+    size_t size = collection.getSize();
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Adding (plus find time)" << size << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i++)
+    {
+      index = static_cast<size_t >(distribution(generator));
+      collection.find(index);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << n << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    auto it = collection.begin();
+    while(it != collection.end())
+    {
+      it = collection.remove(it);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Removing " << size << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+  }
+
+  struct GroupHash //every run of eight consecutive keys shares one hash, or every key does when group is 0
+  {
+    size_t group = 8;
+
+    size_t operator()(size_t key) const
+    {
+      return group == 0 ? 0 : key / group;
+    }
+  };
+
+  bool performRobinHoodCollisionTest(size_t n) //colliding keys must neither grow the table without end nor get lost
+  {
+    std::cout << "RobinHoodHashMap colliding keys tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    aisdi::RobinHoodHashMap<size_t, size_t, GroupHash> clustered;
+    for(size_t i = 0; i < n; i++)
+    {
+      clustered[i] = i;
+    }
+
+    size_t wrong = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+      wrong += clustered.valueOf(i) != i;
+    }
+
+    //keys sharing one hash outgrow any probe limit, they must still all be found, iterated and removed
+    aisdi::RobinHoodHashMap<size_t, size_t, GroupHash> same(GroupHash{0});
+    for(size_t i = 0; i < 1000; i++)
+    {
+      same[i] = i;
+    }
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+      wrong += same.valueOf(i) != i;
+    }
+
+    size_t iterated = 0;
+    for(auto it = same.cbegin(); it != same.cend(); ++it, ++iterated)
+    {
+      wrong += it->first != it->second;
+    }
+
+    for(size_t i = 0; i < 1000; i += 2)
+    {
+      same.remove(i);
+    }
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+      wrong += (same.find(i) != same.end()) != (i % 2 == 1);
+    }
+
+    bool passed = wrong == 0 && clustered.getSize() == n && iterated == 1000 && same.getSize() == 500;
+    std::cout << (passed ? "colliding keys are handled" : "COLLIDING KEYS BROKE THE MAP") << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool performCuckooCollisionTest(size_t n) //colliding keys must neither grow the stash past its cap nor get lost
+  {
+    std::cout << "CuckooHashMap colliding keys tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    aisdi::CuckooHashMap<size_t, size_t, GroupHash> clustered(GroupHash{4});
+    for(size_t i = 0; i < n; i++)
+    {
+      clustered[i] = i;
+    }
+
+    size_t wrong = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+      wrong += clustered.valueOf(i) != i;
+    }
+
+    //eight keys sharing one hash fill both buckets of that hash in insertion order, keys 4..7 take the second bucket's
+    //four slots, the last of which straddles into the bucket's second cache line for these 16-byte entries
+    aisdi::CuckooHashMap<size_t, size_t, GroupHash> paired(GroupHash{0});
+    for(size_t i = 0; i < 2 * aisdi::cuckooSlotsPerBucket; i++)
+    {
+      paired[i] = 10 * i;
+    }
+
+    for(size_t i = 0; i < 2 * aisdi::cuckooSlotsPerBucket; i++)
+    {
+      auto found = paired.find(i);
+      bool lastInBucket = i % aisdi::cuckooSlotsPerBucket == aisdi::cuckooSlotsPerBucket - 1;
+
+      wrong += found == paired.end() || found->second != 10 * i;
+      if(found == paired.end() || lastInBucket)
+        continue;
+
+      ++found;
+      wrong += found != paired.find(i + 1);   //a bucket's slots are consecutive positions
+    }
+    wrong += paired.getStashSize() != 0;
+
+    aisdi::CuckooHashMap<size_t, size_t, GroupHash> same(GroupHash{0});
+    bool rejected = false;
+    try
+    {
+      for(size_t i = 0; i < 1000; i++)
+      {
+        same[i] = i;
+      }
+    }
+    catch(std::length_error&)
+    {
+      rejected = true;
+    }
+
+    for(auto it = same.cbegin(); it != same.cend(); ++it)
+    {
+      wrong += it->first != it->second;
+    }
+
+    bool passed = wrong == 0 && clustered.getSize() == n && clustered.getStashSize() <= aisdi::cuckooStashSize
+                  && rejected && same.getSize() == 2 * aisdi::cuckooSlotsPerBucket + aisdi::cuckooStashSize;
+    std::cout << "Keys sharing one hash are rejected after " << same.getSize() << " entries" << std::endl;
+    std::cout << (passed ? "colliding keys are handled" : "COLLIDING KEYS BROKE THE MAP") << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool performConcurrentHashMapTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    ConcurrentHashMap<size_t, size_t> collection;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "ConcurrentHashMap tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    for(size_t i = 0; i < n; i++)
+    {
+      collection.insert_or_assign(i, i);
+    }
+
+    //read scaling, every thread performs n lookups
+    for(size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+      std::vector<std::thread> workers;
+
+      start = std::chrono::system_clock::now();
+      for(size_t t = 0; t < threads; t++)
+      {
+        workers.emplace_back([&collection, n, t]()
+        {
+          std::default_random_engine generator(t);
+          std::uniform_int_distribution<size_t> distribution(0, 2 * n);
+
+          for(size_t i = 0; i < n; i++)
+          {
+            collection.find(distribution(generator));
+          }
+        });
+      }
+      for(auto& worker : workers)
+      {
+        worker.join();
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Searching for " << threads * n << " elements on " << threads << " threads takes: " << timeElapsed.count()
+                << "s (" << static_cast<size_t>(threads * n / timeElapsed.count()) << " lookups/s)" << std::endl;
+    }
+
+    //stress: counters bumped through compute while other threads churn and read
+    ConcurrentHashMap<size_t, size_t> counters;
+    const size_t counterCount = 1024;
+    size_t writers = std::max<size_t>(2, maxThreads / 2);
+    std::vector<std::thread> workers;
+
+    start = std::chrono::system_clock::now();
+    for(size_t t = 0; t < writers; t++)
+    {
+      workers.emplace_back([&counters, n, t, counterCount]()
+      {
+        for(size_t i = 0; i < n; i++)
+        {
+          counters.compute((i + t) % counterCount, [](size_t& value) { value++; });
+        }
+      });
+    }
+    workers.emplace_back([&counters, n, counterCount]()
+    {
+      for(size_t i = 0; i < n; i++)
+      {
+        counters.insert_or_assign(counterCount + i % 4096, i);
+        counters.remove(counterCount + (i * 7) % 4096);
+      }
+    });
+    workers.emplace_back([&counters, n, counterCount]()
+    {
+      for(size_t i = 0; i < n; i++)
+      {
+        counters.find(i % (counterCount + 4096));
+      }
+    });
+    for(auto& worker : workers)
+    {
+      worker.join();
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+
+    size_t total = 0;
+    for(size_t i = 0; i < counterCount; i++)
+    {
+      total += counters.find(i).value_or(0); //with n below counterCount not every counter gets bumped
+    }
+
+    bool passed = total == writers * n;
+    std::cout << "Stress test on " << writers + 2 << " threads takes: " << timeElapsed.count() << "s, "
+              << (passed ? "counters are consistent" : "COUNTERS LOST UPDATES") << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool performReadMostlyHashMapTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    ReadMostlyHashMap<size_t, size_t> collection;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "ReadMostlyHashMap tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    for(size_t i = 0; i < n; i++)
+    {
+      collection.insert_or_assign(i, 2 * i);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Adding " << n << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+
+    //read scaling, every thread performs n lookups
+    for(size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+      std::vector<std::thread> workers;
+
+      start = std::chrono::system_clock::now();
+      for(size_t t = 0; t < threads; t++)
+      {
+        workers.emplace_back([&collection, n, t]()
+        {
+          std::default_random_engine generator(t);
+          std::uniform_int_distribution<size_t> distribution(0, 2 * n);
+
+          for(size_t i = 0; i < n; i++)
+          {
+            collection.find(distribution(generator));
+          }
+        });
+      }
+      for(auto& worker : workers)
+      {
+        worker.join();
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Searching for " << threads * n << " elements on " << threads << " threads takes: " << timeElapsed.count()
+                << "s (" << static_cast<size_t>(threads * n / timeElapsed.count()) << " lookups/s)" << std::endl;
+    }
+
+    //stress: readers verify every value they see while a writer reassigns, churns and grows the table
+    std::atomic<size_t> errors(0);
+    size_t readers = std::max<size_t>(2, maxThreads);
+    std::vector<std::thread> workers;
+
+    start = std::chrono::system_clock::now();
+    for(size_t t = 0; t < readers; t++)
+    {
+      workers.emplace_back([&collection, &errors, n, t]()
+      {
+        std::default_random_engine generator(t);
+        std::uniform_int_distribution<size_t> distribution(0, 2 * n);
+
+        for(size_t i = 0; i < n; i++)
+        {
+          size_t key = distribution(generator);
+          std::optional<size_t> value = collection.find(key);
+
+          if(key < n ? !value || *value != 2 * key : value && *value != key + 1)
+            errors++;
+        }
+      });
+    }
+    workers.emplace_back([&collection, n]()
+    {
+      for(size_t i = 0; i < n; i++)
+      {
+        collection.insert_or_assign(i, 2 * i);
+        collection.insert_or_assign(n + i, n + i + 1);
+        collection.remove(n + (i * 7) % (i + 1));
+      }
+    });
+    for(auto& worker : workers)
+    {
+      worker.join();
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+
+    collection.remove(2 * n + 1); //with every reader gone the next write frees all retired memory
+    collection.insert_or_assign(0, 0);
+
+    bool passed = errors == 0 && collection.getPendingReclamation() == 0;
+    std::cout << "Stress test on " << readers + 1 << " threads takes: " << timeElapsed.count() << "s, "
+              << (passed ? "reads are consistent and memory is reclaimed" : "INCONSISTENT READS OR LEAKED NODES") << std::endl;
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool performSnapshotTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    HashMap<size_t, size_t> collection;
+    std::string path = (std::filesystem::temp_directory_path() / "aisdiMaps.snapshot").string();
+
+    std::cout << "HashMap snapshot tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    for(size_t i = 0; i < n; i++)
+    {
+      collection[i] = 3 * i;
+    }
+
+    start = std::chrono::system_clock::now();
+    aisdi::saveSnapshot(collection, path);
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Saving " << n << " elements takes: " << timeElapsed.count() << "s" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    HashMap<size_t, size_t> rebuilt;
+    for(auto it = collection.cbegin(); it != collection.cend(); ++it)
+    {
+      rebuilt[it->first] = it->second;
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Rebuilding " << n << " elements by insertion takes: " << timeElapsed.count() << "s" << std::endl;
+
+    start = std::chrono::system_clock::now();
+    bool passed;
+    {
+      aisdi::MappedHashMap<size_t, size_t> mapped(path);
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      std::cout << "Opening " << n << " elements through mmap takes: " << timeElapsed.count() << "s" << std::endl;
+
+      size_t wrong = 0;
+      start = std::chrono::system_clock::now();
+      for(size_t i = 0; i < 2 * n; i++)
+      {
+        const size_t* value = mapped.find(i);
+
+        if(i < n ? value == nullptr || *value != 3 * i : value != nullptr)
+          wrong++;
+      }
+      end = std::chrono::system_clock::now();
+      timeElapsed = end - start;
+      passed = wrong == 0 && mapped.getSize() == n;
+      std::cout << "Searching for " << 2 * n << " elements in the mapped image takes: " << timeElapsed.count() << "s, "
+                << (passed ? "snapshot matches the map" : "SNAPSHOT DIFFERS FROM THE MAP") << std::endl;
+    }
+
+    //an offset in the middle that runs past the entries must be refused on open, not read past on lookup
+    bool refused = false;
+    {
+      std::fstream image(path, std::ios::binary | std::ios::in | std::ios::out);
+      aisdi::SnapshotHeader header;
+      image.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+      std::uint64_t damaged = header.entryCount + 1000;
+      image.seekp(sizeof(header) + header.bucketCount / 2 * sizeof(std::uint64_t));
+      image.write(reinterpret_cast<const char*>(&damaged), sizeof(damaged));
+    }
+    try
+    {
+      aisdi::MappedHashMap<size_t, size_t> mapped(path);
+    }
+    catch(const std::runtime_error&)
+    {
+      refused = true;
+    }
+    passed = refused && passed;
+    std::cout << "Opening an image with a damaged bucket offset: "
+              << (refused ? "refused" : "ACCEPTED") << std::endl;
+    std::filesystem::remove(path);
+
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool performFrozenHashMapTest(size_t n)
+  {
+    time_type start, end;
+    duration_type timeElapsed;
+    HashMap<size_t, size_t> collection;
+    std::mt19937_64 generator(n);
+    std::vector<size_t> keys(n);
+
+    std::cout << "FrozenHashMap tests: " << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+
+    for(size_t i = 0; i < n; i++)
+    {
+      keys[i] = 2 * i;
+      collection[keys[i]] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), generator);
+
+    start = std::chrono::system_clock::now();
+    aisdi::FrozenHashMap<size_t, size_t> frozen(collection);
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Building from " << n << " elements takes: " << timeElapsed.count() << "s, "
+              << (n > 0 ? frozen.getIndexBytes() * 8.0 / n : 0.0) << " index bits per key" << std::endl;
+
+    size_t sum = 0;
+    start = std::chrono::system_clock::now();
+    for(size_t key : keys)
+    {
+      sum += collection.valueOf(key);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << n << " elements in HashMap takes: " << timeElapsed.count() << "s" << std::endl;
+
+    size_t frozenSum = 0;
+    start = std::chrono::system_clock::now();
+    for(size_t key : keys)
+    {
+      frozenSum += frozen.valueOf(key);
+    }
+    end = std::chrono::system_clock::now();
+    timeElapsed = end - start;
+    std::cout << "Searching for " << n << " elements in FrozenHashMap takes: " << timeElapsed.count() << "s" << std::endl;
+
+    size_t misses = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+      misses += frozen.contains(2 * i + 1) ? 0 : 1;
+    }
+
+    bool passed = frozen.getSize() == n && frozenSum == sum && misses == n;
+    std::cout << (passed ? "Frozen map matches the HashMap" : "FROZEN MAP DIFFERS FROM THE HASHMAP") << std::endl;
+    std::cout << "--------------------------------------------------------------------------------" << std::endl;
+    return passed;
+  }
+
+  bool perfomTest(size_t n)
   {
     performTreeMapTest(n);
-    performHashMapTest(n);
+    bool passed = performBTreeMapTest(n);
+    performHashMapTest<HashMap<size_t, std::string>>(n, "HashMap");
+    performHashMapTest<PooledHashMap<size_t, std::string>>(n, "HashMap (pool allocator)");
+    performIncrementalRehashTest(n);
+    passed = performParallelScanTest(n) && passed;
+    performOpenAddressingTest<RobinHoodHashMap<size_t, std::string>>(n, "RobinHoodHashMap");
+    passed = performRobinHoodCollisionTest(n) && passed;
+    performOpenAddressingTest<SwissHashMap<size_t, std::string>>(n, "SwissHashMap");
+    performOpenAddressingTest<CuckooHashMap<size_t, std::string>>(n, "CuckooHashMap");
+    passed = performCuckooCollisionTest(n) && passed;
+    passed = performConcurrentHashMapTest(n) && passed;
+    passed = performReadMostlyHashMapTest(n) && passed;
+    passed = performSnapshotTest(n) && passed;
+    return performFrozenHashMapTest(n) && passed;
   }
 
 } // namespace
@@ -134,6 +1003,5 @@ namespace
 int main(int argc, char** argv)
 {
   const std::size_t repeatCount = argc > 1 ? std::atoll(argv[1]) : 500000;
-  perfomTest(repeatCount);
-  return 0;
+  return perfomTest(repeatCount) ? EXIT_SUCCESS : EXIT_FAILURE;
 }